@@ -0,0 +1,52 @@
+#include "bench.hpp"
+
+#include <core/application.hpp>
+#include <core/exception.hpp>
+
+#include <cstdlib>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+class FrameCountingApp final : public Application
+{
+public:
+    explicit FrameCountingApp(u64 frames) : m_frames_left(frames) {}
+
+    void on_update(SURREAL_UNUSED(float, delta_time)) override
+    {
+        if (!m_frames_left--)
+            quit();
+    }
+
+private:
+    u64 m_frames_left;
+};
+
+// Runs a full Application, window and event drain included. Needs an X server; use Xvfb on headless hosts.
+void application_frames(State& state)
+{
+    if (!std::getenv("DISPLAY"))
+    {
+        state.skip("DISPLAY is not set (run under xvfb-run)");
+        return;
+    }
+
+    try
+    {
+        FrameCountingApp app{ state.iterations() };
+        app.run();
+    }
+    catch (const Exception& e)
+    {
+        state.skip(e.what());
+    }
+}
+SURREAL_BENCHMARK_FIXED(application_frames, 2000u);
+
+} // namespace
+
+} // namespace Surreal::Bench
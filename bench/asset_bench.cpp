@@ -0,0 +1,99 @@
+#include "bench.hpp"
+
+#include <core/asset.hpp>
+#include <core/lz4.hpp>
+
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+constexpr std::size_t s_entry_count{ 64u };
+constexpr std::size_t s_entry_size{ 256u * 1024u };
+
+// Mildly compressible data: runs of a small alphabet, roughly what mesh indices and texture mips look like to LZ4.
+std::vector<u8> make_asset(u32 seed)
+{
+    std::mt19937 rng{ seed };
+    std::vector<u8> data(s_entry_size);
+    for (std::size_t i{ 0u }; i < data.size();)
+    {
+        const u8 value{ static_cast<u8>(rng() % 16u) };
+        for (std::size_t run{ rng() % 8u + 1u }; run && i < data.size(); --run)
+            data[i++] = value;
+    }
+    return data;
+}
+
+const std::string& get_pack_path()
+{
+    static const std::string s_path{ [] {
+        const std::string path{ (std::filesystem::temp_directory_path() / "surreal_bench.pak").string() };
+        AssetPackBuilder builder;
+        for (u32 i{ 0u }; i < s_entry_count; ++i)
+            builder.add("asset" + std::to_string(i), make_asset(i));
+        ThreadPool pool;
+        builder.write(path, pool);
+        return path;
+    }() };
+    return s_path;
+}
+
+void asset_lz4_decompress_256k(State& state)
+{
+    const std::vector<u8> data{ make_asset(0u) };
+    std::vector<u8> compressed(lz4_compress_bound(data.size()));
+    compressed.resize(lz4_compress(data, compressed));
+
+    std::vector<u8> out(data.size());
+    while (state.keep_running())
+    {
+        bool ok{ lz4_decompress(compressed, out) };
+        do_not_optimize(ok);
+    }
+}
+SURREAL_BENCHMARK(asset_lz4_decompress_256k);
+
+void asset_load_sync_64(State& state)
+{
+    const AssetPack pack{ get_pack_path() };
+    while (state.keep_running())
+    {
+        for (const PackEntry& entry : pack.get_entries())
+        {
+            std::vector<u8> data{ pack.load(entry) };
+            do_not_optimize(data);
+        }
+    }
+}
+SURREAL_BENCHMARK(asset_load_sync_64);
+
+// Request everything, then poll as a frame loop would until every callback has run.
+void asset_stream_64(State& state)
+{
+    const AssetPack pack{ get_pack_path() };
+    ThreadPool pool;
+    AssetStreamer streamer{ pack, pool };
+
+    while (state.keep_running())
+    {
+        for (const PackEntry& entry : pack.get_entries())
+            streamer.request(entry, 0, [](StreamResult& result) { do_not_optimize(result.data); });
+        while (streamer.get_pending_count())
+        {
+            streamer.poll();
+            std::this_thread::yield();
+        }
+    }
+}
+SURREAL_BENCHMARK(asset_stream_64);
+
+} // namespace
+
+} // namespace Surreal::Bench
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <core/base.hpp>
+
+#include <string>
+#include <vector>
+
+namespace Surreal::Bench
+{
+
+// Keeps the optimizer from discarding a value computed inside a benchmark loop.
+template <typename Tp>
+SURREAL_ALWAYS_INLINE void do_not_optimize(Tp& value) noexcept
+{
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+SURREAL_ALWAYS_INLINE void clobber_memory() noexcept
+{
+    asm volatile("" : : : "memory");
+}
+
+class State
+{
+public:
+    explicit State(u64 iterations) : m_iterations(iterations), m_remaining(iterations), m_skip_reason() {}
+
+    SURREAL_ALWAYS_INLINE bool keep_running() noexcept
+    {
+        if (m_remaining) SURREAL_LIKELY
+        {
+            --m_remaining;
+            return true;
+        }
+        return false;
+    }
+
+    constexpr u64 iterations() const noexcept { return m_iterations; }
+
+    // Marks the benchmark as not runnable in this environment (e.g. no display for macro benchmarks).
+    void skip(const std::string& reason) { m_skip_reason = reason; }
+    bool skipped() const noexcept { return !m_skip_reason.empty(); }
+    const std::string& skip_reason() const noexcept { return m_skip_reason; }
+
+private:
+    u64 m_iterations;
+    u64 m_remaining;
+    std::string m_skip_reason;
+};
+
+typedef void (*BenchmarkFunc)(State&);
+
+struct Benchmark
+{
+    const char* name;
+    BenchmarkFunc func;
+    // Zero lets the runner calibrate the iteration count, anything else is used as-is.
+    u64 fixed_iterations;
+};
+
+std::vector<Benchmark>& registry();
+
+struct Registrar
+{
+    Registrar(const char* name, BenchmarkFunc func, u64 fixed_iterations = 0u)
+    {
+        registry().push_back({ name, func, fixed_iterations });
+    }
+};
+
+} // namespace Surreal::Bench
+
+#define SURREAL_BENCH_CONCAT_IMPL(a, b) a##b
+#define SURREAL_BENCH_CONCAT(a, b) SURREAL_BENCH_CONCAT_IMPL(a, b)
+
+#define SURREAL_BENCHMARK(func)                                                                                        \
+    static ::Surreal::Bench::Registrar SURREAL_BENCH_CONCAT(s_bench_registrar_, __LINE__){ #func, func }
+
+#define SURREAL_BENCHMARK_FIXED(func, iterations)                                                                      \
+    static ::Surreal::Bench::Registrar SURREAL_BENCH_CONCAT(s_bench_registrar_, __LINE__){ #func, func, iterations }
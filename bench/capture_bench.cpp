@@ -0,0 +1,101 @@
+#include "bench.hpp"
+
+#include <core/capture.hpp>
+
+#include <filesystem>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+constexpr Size s_frame_size{ 1920u, 1080u };
+
+std::string get_capture_path(CaptureFormat format)
+{
+    return (std::filesystem::temp_directory_path() / ("surreal_bench." + std::string(to_string(format)))).string();
+}
+
+// A dashboard-like frame: flat background, a grid of panels and a bar that moves every frame.
+void draw_frame(Surface& surface, u32 frame)
+{
+    surface.clear(make_pixel(24u, 26u, 30u));
+    for (u32 y{ 40u }; y < s_frame_size.h - 40u; ++y)
+    {
+        Pixel* row{ surface.get_row(y) };
+        for (u32 x{ 40u }; x < s_frame_size.w - 40u; ++x)
+            if ((x / 300u + y / 200u) % 2u == 0u && x % 300u > 8u && y % 200u > 8u)
+                row[x] = make_pixel(static_cast<u8>(40u + x / 30u), 48u, static_cast<u8>(60u + y / 20u));
+    }
+
+    const u32 bar_x{ (frame * 16u) % (s_frame_size.w - 200u) };
+    for (u32 y{ 1000u }; y < 1020u; ++y)
+        std::fill_n(surface.get_row(y) + bar_x, 200u, make_pixel(220u, 120u, 40u));
+}
+
+// Main-thread cost of handing a changed frame over, which is all the frame loop pays. Frames the pipeline has no room
+// for are dropped, so this never waits for the disk.
+void capture_submit_1080p(State& state)
+{
+    ThreadPool pool;
+    Surface surface;
+    surface.resize(s_frame_size);
+    draw_frame(surface, 0u);
+
+    const std::string path{ get_capture_path(CaptureFormat::Qoi) };
+    {
+        FrameCapture capture{ { path, CaptureFormat::Qoi, CaptureOverflow::Drop, 60u, 4u, true }, s_frame_size, pool };
+        while (state.keep_running())
+        {
+            // Stands in for a full redraw; a surface that is only marked dirty would stay stale after the first swap.
+            surface.get_row(0u)[0] = make_pixel(0u, 0u, 0u);
+            bool submitted{ capture.submit(surface) };
+            do_not_optimize(submitted);
+        }
+    }
+    std::filesystem::remove(path);
+}
+SURREAL_BENCHMARK(capture_submit_1080p);
+
+// Sustained frame time with backpressure: drawing, encoding and writing overlap, so this is the slowest of them.
+void capture_throughput_1080p(State& state, CaptureFormat format)
+{
+    ThreadPool pool;
+    Surface surface;
+    surface.resize(s_frame_size);
+
+    const std::string path{ get_capture_path(format) };
+    {
+        FrameCapture capture{ { path, format, CaptureOverflow::Block, 60u, 4u, true }, s_frame_size, pool };
+        u32 frame{ 0u };
+        while (state.keep_running())
+        {
+            draw_frame(surface, frame++);
+            capture.submit(surface);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+void capture_raw_1080p(State& state)
+{
+    capture_throughput_1080p(state, CaptureFormat::Raw);
+}
+SURREAL_BENCHMARK_FIXED(capture_raw_1080p, 120);
+
+void capture_y4m_1080p(State& state)
+{
+    capture_throughput_1080p(state, CaptureFormat::Y4m);
+}
+SURREAL_BENCHMARK_FIXED(capture_y4m_1080p, 120);
+
+void capture_qoi_1080p(State& state)
+{
+    capture_throughput_1080p(state, CaptureFormat::Qoi);
+}
+SURREAL_BENCHMARK_FIXED(capture_qoi_1080p, 120);
+
+} // namespace
+
+} // namespace Surreal::Bench
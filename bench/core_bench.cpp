@@ -0,0 +1,311 @@
+#include "bench.hpp"
+
+#include <core/action.hpp>
+#include <core/event.hpp>
+#include <core/flags.hpp>
+#include <core/input.hpp>
+#include <core/window.hpp>
+
+#include <chrono>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+class CountingHandler final : public EventHandler
+{
+public:
+    void operator()(KeyEvent& ke) override
+    {
+        m_count += ke.get_scancode();
+        ke.handled = true;
+    }
+
+    void operator()(MouseEvent& me) override
+    {
+        if (me.get_type() == EventType::MouseRawMotion)
+        {
+            for (const auto& sample : static_cast<MouseRawMotionEvent&>(me).get_samples())
+                m_count += static_cast<u64>(sample.dx);
+        }
+        else if (me.get_type() == EventType::MouseMove)
+            m_count += static_cast<MouseMoveEvent&>(me).get_position().x;
+        me.handled = true;
+    }
+
+    void operator()(WindowEvent& we) override
+    {
+        m_count += we.get_id();
+        we.handled = true;
+    }
+
+    u64 m_count{ 0u };
+};
+
+// Mirrors the handler fan-out of LinuxWindow::on_* without a connection to the X server.
+class NullWindow final : public Window
+{
+public:
+    NullWindow() : Window(0u) {}
+
+    constexpr Size get_size() const noexcept override { return {}; }
+    constexpr Position get_position() const noexcept override { return {}; }
+    constexpr Rect get_rect() const noexcept override { return {}; }
+
+    void on_update() override {}
+    void present() override {}
+    void show() noexcept override {}
+    void hide() noexcept override {}
+
+    void emit_key_press(u32 key)
+    {
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            KeyPressEvent e{ Key::A, key };
+            (*handler)(e);
+        }
+    }
+
+    void emit_mouse_move(Position pos)
+    {
+        MouseMoveEvent routed{ m_id, pos };
+        if (m_hit_regions.route(routed, pos))
+            return;
+
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            MouseMoveEvent e{ m_id, pos };
+            (*handler)(e);
+        }
+    }
+
+    void emit_raw_motion(std::span<const MouseRawSample> samples)
+    {
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            MouseRawMotionEvent e{ m_id, samples };
+            (*handler)(e);
+        }
+    }
+
+    void emit_configure(Rect rect)
+    {
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            WindowResizeEvent s{ m_id, rect.size };
+            (*handler)(s);
+            WindowPositionEvent p{ m_id, rect.pos };
+            (*handler)(p);
+        }
+    }
+};
+
+void flags_or_and(State& state)
+{
+    EventCategoryFlags flags{};
+    u32 hits{ 0u };
+    while (state.keep_running())
+    {
+        flags |= EventCategoryFlagBits::Keyboard;
+        flags |= EventCategoryFlagBits::Mouse;
+        hits += static_cast<bool>(flags & EventCategoryFlagBits::Mouse);
+        flags &= EventCategoryFlagBits::Window;
+        do_not_optimize(flags);
+    }
+    do_not_optimize(hits);
+}
+SURREAL_BENCHMARK(flags_or_and);
+
+void flags_invert_compare(State& state)
+{
+    EventCategoryFlags flags{ EventCategoryFlagBits::Window | EventCategoryFlagBits::Keyboard };
+    u32 equal{ 0u };
+    while (state.keep_running())
+    {
+        flags = ~flags;
+        equal += flags == EventCategoryFlags(EventCategoryFlagBits::Mouse);
+        do_not_optimize(flags);
+    }
+    do_not_optimize(equal);
+}
+SURREAL_BENCHMARK(flags_invert_compare);
+
+void event_dispatch_hit(State& state)
+{
+    KeyPressEvent e{ Key::Escape, 9u };
+    u64 sum{ 0u };
+    while (state.keep_running())
+    {
+        Event* ev{ &e };
+        do_not_optimize(ev);
+        EventDispatcher dispatcher{ *ev };
+        dispatcher.dispatch<KeyPressEvent>([&](KeyPressEvent& kp) { sum += kp.get_scancode(); });
+    }
+    do_not_optimize(sum);
+}
+SURREAL_BENCHMARK(event_dispatch_hit);
+
+void event_dispatch_miss_chain(State& state)
+{
+    WindowResizeEvent e{ 0u, { 1280u, 720u } };
+    u64 sum{ 0u };
+    while (state.keep_running())
+    {
+        Event* ev{ &e };
+        do_not_optimize(ev);
+        EventDispatcher dispatcher{ *ev };
+        dispatcher.dispatch<KeyPressEvent>([&](KeyPressEvent& kp) { sum += kp.get_scancode(); });
+        dispatcher.dispatch<KeyReleaseEvent>([&](KeyReleaseEvent& kr) { sum += kr.get_scancode(); });
+        dispatcher.dispatch<WindowCloseEvent>([&](WindowCloseEvent& wc) { sum += wc.get_id(); });
+        dispatcher.dispatch<WindowPositionEvent>([&](WindowPositionEvent& wp) { sum += wp.get_position().x; });
+        dispatcher.dispatch<WindowResizeEvent>([&](WindowResizeEvent& wr) { sum += wr.get_size().w; });
+    }
+    do_not_optimize(sum);
+}
+SURREAL_BENCHMARK(event_dispatch_miss_chain);
+
+template <u32 HandlerCount>
+void handler_fanout_key(State& state)
+{
+    NullWindow window;
+    CountingHandler handlers[HandlerCount];
+    for (auto& h : handlers)
+        window.push_event_handler(&h);
+
+    u32 key{ 0u };
+    while (state.keep_running())
+        window.emit_key_press(key++ & 0xffu);
+
+    do_not_optimize(handlers[0].m_count);
+}
+SURREAL_BENCHMARK(handler_fanout_key<1>);
+SURREAL_BENCHMARK(handler_fanout_key<8>);
+SURREAL_BENCHMARK(handler_fanout_key<64>);
+
+void handler_fanout_configure(State& state)
+{
+    NullWindow window;
+    CountingHandler handlers[8];
+    for (auto& h : handlers)
+        window.push_event_handler(&h);
+
+    while (state.keep_running())
+        window.emit_configure({ { 10u, 20u }, { 1280u, 720u } });
+
+    do_not_optimize(handlers[0].m_count);
+}
+SURREAL_BENCHMARK(handler_fanout_configure);
+
+void keyboard_state_poll(State& state)
+{
+    KeyboardState keyboard;
+    keyboard.press(Key::W);
+    keyboard.press(Key::LeftShift);
+
+    constexpr Key polled[]{ Key::W, Key::A, Key::S, Key::D, Key::Space, Key::LeftShift, Key::LeftControl, Key::E };
+    u32 down{ 0u };
+    while (state.keep_running())
+    {
+        for (Key key : polled)
+            down += keyboard.is_down(key) + keyboard.was_pressed(key);
+        do_not_optimize(keyboard);
+    }
+    do_not_optimize(down);
+}
+SURREAL_BENCHMARK(keyboard_state_poll);
+
+// Press/release pair resolved through a table holding one binding per letter and digit key.
+void action_map_resolve(State& state)
+{
+    ActionBindings bindings;
+    for (u16 key{ static_cast<u16>(Key::A) }; key <= static_cast<u16>(Key::Num9); ++key)
+        bindings.bind(bindings.add_action(fmt::format("action_{}", key)), static_cast<Key>(key));
+
+    ActionMap actions;
+    actions.set_bindings(bindings);
+    actions.begin_frame();
+
+    u32 key{ 0u };
+    while (state.keep_running())
+    {
+        const Key k{ static_cast<Key>(static_cast<u32>(Key::A) + key++ % 36u) };
+        KeyPressEvent press{ k, 0u };
+        actions(press);
+        KeyReleaseEvent release{ k, 0u };
+        actions(release);
+    }
+    do_not_optimize(actions);
+}
+SURREAL_BENCHMARK(action_map_resolve);
+
+// A 1000 Hz mouse at 60 fps delivers ~16 samples per frame: one event per sample versus one batch per frame.
+void mouse_motion_per_sample(State& state)
+{
+    NullWindow window;
+    CountingHandler handlers[8];
+    for (auto& h : handlers)
+        window.push_event_handler(&h);
+
+    while (state.keep_running())
+    {
+        for (u32 i{ 0u }; i < 16u; ++i)
+            window.emit_mouse_move({ i, i });
+    }
+
+    do_not_optimize(handlers[0].m_count);
+}
+SURREAL_BENCHMARK(mouse_motion_per_sample);
+
+void mouse_motion_batched(State& state)
+{
+    NullWindow window;
+    CountingHandler handlers[8];
+    for (auto& h : handlers)
+        window.push_event_handler(&h);
+
+    MouseRawSample samples[16];
+    for (u32 i{ 0u }; i < 16u; ++i)
+        samples[i] = { static_cast<f32>(i), static_cast<f32>(i), i };
+
+    while (state.keep_running())
+        window.emit_raw_motion(samples);
+
+    do_not_optimize(handlers[0].m_count);
+}
+SURREAL_BENCHMARK(mouse_motion_batched);
+
+// The body of Application::run with an empty update and a window that has no events to drain.
+void frame_loop_overhead(State& state)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    typedef std::chrono::duration<float> Seconds;
+
+    NullWindow null_window;
+    Window* window{ &null_window };
+    do_not_optimize(window);
+
+    float elapsed_time{ 0.0f };
+    auto start_time{ Clock::now() };
+    while (state.keep_running())
+    {
+        auto end_time{ Clock::now() };
+        Seconds delta_time{ end_time - start_time };
+
+        window->on_update();
+
+        elapsed_time += delta_time.count();
+        start_time = end_time;
+    }
+    do_not_optimize(elapsed_time);
+}
+SURREAL_BENCHMARK(frame_loop_overhead);
+
+} // namespace
+
+} // namespace Surreal::Bench
@@ -0,0 +1,129 @@
+#include "bench.hpp"
+
+#include <core/ecs.hpp>
+#include <core/system.hpp>
+#include <core/thread_pool.hpp>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+struct Position
+{
+    f32 x, y, z;
+};
+
+struct Velocity
+{
+    f32 x, y, z;
+};
+
+struct Health
+{
+    f32 value;
+};
+
+constexpr u32 s_entity_count{ 500000u };
+
+void populate(World& world)
+{
+    for (u32 i{ 0u }; i < s_entity_count; ++i)
+    {
+        const Entity entity{ world.create(Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 2.0f, 3.0f }) };
+        // A quarter of the entities land in a second archetype so queries span more than one.
+        if (i % 4u == 0u)
+            world.add(entity, Health{ 100.0f });
+    }
+}
+
+void ecs_iterate_500k(State& state)
+{
+    World world;
+    populate(world);
+    auto query{ world.query<const Velocity, Position>() };
+
+    while (state.keep_running())
+    {
+        query.each([](const Velocity& v, Position& p) {
+            p.x += v.x * 0.016f;
+            p.y += v.y * 0.016f;
+            p.z += v.z * 0.016f;
+        });
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(ecs_iterate_500k);
+
+void ecs_parallel_iterate_500k(State& state)
+{
+    ThreadPool pool;
+    if (!pool.get_thread_count())
+    {
+        state.skip("no worker threads");
+        return;
+    }
+
+    World world;
+    populate(world);
+    auto query{ world.query<const Velocity, Position>() };
+
+    while (state.keep_running())
+    {
+        query.parallel_each(pool, [](const Velocity& v, Position& p) {
+            p.x += v.x * 0.016f;
+            p.y += v.y * 0.016f;
+            p.z += v.z * 0.016f;
+        });
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(ecs_parallel_iterate_500k);
+
+void ecs_scheduler_frame(State& state)
+{
+    ThreadPool pool;
+    World world;
+    populate(world);
+
+    SystemScheduler systems{ world, pool };
+    systems.add_system<const Velocity, Position>("integrate",
+                                                 [](auto& query, CommandBuffer&, f32 delta_time) {
+                                                     query.each([delta_time](const Velocity& v, Position& p) {
+                                                         p.x += v.x * delta_time;
+                                                         p.y += v.y * delta_time;
+                                                         p.z += v.z * delta_time;
+                                                     });
+                                                 });
+    systems.add_system<Health>("regenerate", [](auto& query, CommandBuffer&, f32 delta_time) {
+        query.each([delta_time](Health& h) { h.value += delta_time; });
+    });
+
+    while (state.keep_running())
+        systems.run(0.016f);
+}
+SURREAL_BENCHMARK(ecs_scheduler_frame);
+
+void ecs_create_destroy(State& state)
+{
+    World world;
+    CommandBuffer commands;
+    std::vector<Entity> entities;
+    entities.reserve(1024u);
+
+    while (state.keep_running())
+    {
+        for (u32 i{ 0u }; i < 1024u; ++i)
+            entities.push_back(world.create(Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 1.0f, 1.0f }));
+        for (Entity entity : entities)
+            commands.destroy(entity);
+        world.flush(commands);
+        entities.clear();
+    }
+}
+SURREAL_BENCHMARK(ecs_create_destroy);
+
+} // namespace
+
+} // namespace Surreal::Bench
@@ -0,0 +1,144 @@
+#include "bench.hpp"
+
+#include <core/hit_test.hpp>
+
+#include <random>
+#include <vector>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+constexpr Size s_screen{ 1920u, 1080u };
+constexpr u32 s_region_count{ 4000u };
+constexpr u32 s_query_count{ 1024u };
+
+class NullHandler final : public EventHandler
+{
+public:
+    void operator()(KeyEvent&) override {}
+    void operator()(MouseEvent& me) override { me.handled = true; }
+    void operator()(WindowEvent&) override {}
+};
+
+// A dashboard: a tiling of small widgets with a few hundred larger panels and popups stacked over it.
+std::vector<Rect> make_dashboard()
+{
+    std::mt19937 rng{ 7u };
+    const auto next = [&](u32 n) { return static_cast<u32>(rng() % n); };
+
+    std::vector<Rect> rects;
+    for (u32 i{ 0u }; i < s_region_count; ++i)
+    {
+        const bool panel{ i % 16u == 15u };
+        const u32 w{ panel ? 160u + next(320u) : 16u + next(48u) };
+        const u32 h{ panel ? 120u + next(240u) : 12u + next(24u) };
+        rects.push_back({ { next(s_screen.w - w), next(s_screen.h - h) }, { w, h } });
+    }
+    return rects;
+}
+
+std::vector<Position> make_queries()
+{
+    std::mt19937 rng{ 11u };
+    std::vector<Position> queries;
+    for (u32 i{ 0u }; i < s_query_count; ++i)
+        queries.push_back({ static_cast<u32>(rng() % s_screen.w), static_cast<u32>(rng() % s_screen.h) });
+    return queries;
+}
+
+// What every handler did before: walk its regions back to front and take the first one containing the point.
+void hit_test_linear_4000(State& state)
+{
+    const std::vector<Rect> rects{ make_dashboard() };
+    const std::vector<Position> queries{ make_queries() };
+    while (state.keep_running())
+    {
+        u32 hits{ 0u };
+        for (const Position& pos : queries)
+        {
+            for (auto it{ rects.rbegin() }; it != rects.rend(); ++it)
+            {
+                if (pos.x - it->pos.x < it->size.w && pos.y - it->pos.y < it->size.h)
+                {
+                    ++hits;
+                    break;
+                }
+            }
+        }
+        do_not_optimize(hits);
+    }
+}
+SURREAL_BENCHMARK(hit_test_linear_4000);
+
+void hit_test_grid_4000(State& state)
+{
+    NullHandler handler;
+    HitRegions regions{ s_screen };
+    for (const Rect& rect : make_dashboard())
+        regions.add(&handler, rect);
+
+    const std::vector<Position> queries{ make_queries() };
+    while (state.keep_running())
+    {
+        u32 hits{ 0u };
+        for (const Position& pos : queries)
+            hits += regions.hit_test(pos) != s_null_region;
+        do_not_optimize(hits);
+    }
+}
+SURREAL_BENCHMARK(hit_test_grid_4000);
+
+// Every widget nudged by a pixel, as an animated layout would do each frame.
+void hit_test_move_4000(State& state)
+{
+    NullHandler handler;
+    HitRegions regions{ s_screen };
+    std::vector<Rect> rects{ make_dashboard() };
+    std::vector<HitRegion> handles;
+    for (const Rect& rect : rects)
+        handles.push_back(regions.add(&handler, rect));
+
+    u32 frame{ 0u };
+    while (state.keep_running())
+    {
+        const u32 offset{ frame++ & 1u };
+        for (u32 i{ 0u }; i < rects.size(); ++i)
+            regions.set_rect(handles[i], { { rects[i].pos.x + offset, rects[i].pos.y }, rects[i].size });
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(hit_test_move_4000);
+
+// Relayout after a window resize: the grid is rebuilt, then every region moved to its scaled rectangle.
+void hit_test_resize_4000(State& state)
+{
+    NullHandler handler;
+    HitRegions regions{ s_screen };
+    std::vector<Rect> rects{ make_dashboard() };
+    std::vector<HitRegion> handles;
+    for (const Rect& rect : rects)
+        handles.push_back(regions.add(&handler, rect));
+
+    u32 frame{ 0u };
+    while (state.keep_running())
+    {
+        const bool small{ (frame++ & 1u) != 0u };
+        regions.set_bounds(small ? Size{ s_screen.w / 2u, s_screen.h / 2u } : s_screen);
+        for (u32 i{ 0u }; i < rects.size(); ++i)
+        {
+            const Rect& rect{ rects[i] };
+            regions.set_rect(handles[i], small ? Rect{ { rect.pos.x / 2u, rect.pos.y / 2u },
+                                                       { rect.size.w / 2u, rect.size.h / 2u } }
+                                               : rect);
+        }
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(hit_test_resize_4000);
+
+} // namespace
+
+} // namespace Surreal::Bench
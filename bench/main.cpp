@@ -0,0 +1,301 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace Surreal::Bench
+{
+
+std::vector<Benchmark>& registry()
+{
+    static std::vector<Benchmark> s_registry;
+    return s_registry;
+}
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+typedef std::chrono::duration<f64, std::nano> Nanoseconds;
+
+struct Options
+{
+    std::string filter;
+    std::string out_path;
+    std::string baseline_path;
+    f64 threshold{ 0.10 };
+    f64 min_time{ 0.2 };
+    u32 repetitions{ 5u };
+};
+
+struct Result
+{
+    std::string name;
+    u64 iterations;
+    f64 ns_per_op;
+    f64 min_ns_per_op;
+    f64 max_ns_per_op;
+    std::string skip_reason;
+};
+
+f64 run_once(const Benchmark& bench, u64 iterations, std::string& skip_reason)
+{
+    State state{ iterations };
+    auto start{ Clock::now() };
+    bench.func(state);
+    auto end{ Clock::now() };
+
+    skip_reason = state.skip_reason();
+    return Nanoseconds(end - start).count();
+}
+
+// Grows the iteration count until a single run takes at least min_time seconds.
+u64 calibrate(const Benchmark& bench, f64 min_time, std::string& skip_reason)
+{
+    if (bench.fixed_iterations)
+        return bench.fixed_iterations;
+
+    const f64 min_ns{ min_time * 1e9 };
+    u64 iterations{ 1u };
+    while (true)
+    {
+        const f64 ns{ run_once(bench, iterations, skip_reason) };
+        if (!skip_reason.empty() || ns >= min_ns || iterations >= (u64(1) << 40))
+            return iterations;
+
+        const f64 scale{ ns > 0.0 ? std::min(min_ns * 1.4 / ns, 10.0) : 10.0 };
+        iterations = std::max(iterations + 1u, static_cast<u64>(static_cast<f64>(iterations) * scale));
+    }
+}
+
+Result run(const Benchmark& bench, const Options& opts)
+{
+    Result result{ bench.name, 0u, 0.0, 0.0, 0.0, {} };
+
+    result.iterations = calibrate(bench, opts.min_time, result.skip_reason);
+    if (!result.skip_reason.empty())
+        return result;
+
+    std::vector<f64> samples;
+    samples.reserve(opts.repetitions);
+    for (u32 i{ 0u }; i < opts.repetitions; ++i)
+    {
+        const f64 ns{ run_once(bench, result.iterations, result.skip_reason) };
+        if (!result.skip_reason.empty())
+            return result;
+        samples.push_back(ns / static_cast<f64>(result.iterations));
+    }
+
+    std::sort(samples.begin(), samples.end());
+    result.ns_per_op = samples[samples.size() / 2u];
+    result.min_ns_per_op = samples.front();
+    result.max_ns_per_op = samples.back();
+    return result;
+}
+
+std::string escape(std::string_view s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s)
+    {
+        // JSON strings cannot hold raw control characters; \u00XX covers them all.
+        if (static_cast<unsigned char>(c) < 0x20u)
+        {
+            out += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+std::string to_json(const std::vector<Result>& results)
+{
+    std::string json{ "{\n  \"version\": 1,\n  \"benchmarks\": [\n" };
+    for (std::size_t i{ 0u }; i < results.size(); ++i)
+    {
+        const auto& r{ results[i] };
+        if (!r.skip_reason.empty())
+            json += fmt::format("    {{\"name\": \"{}\", \"skipped\": \"{}\"}}", escape(r.name), escape(r.skip_reason));
+        else
+            json += fmt::format("    {{\"name\": \"{}\", \"iterations\": {}, \"ns_per_op\": {:.4f}, "
+                                "\"min_ns_per_op\": {:.4f}, \"max_ns_per_op\": {:.4f}}}",
+                                escape(r.name), r.iterations, r.ns_per_op, r.min_ns_per_op, r.max_ns_per_op);
+        json += i + 1u < results.size() ? ",\n" : "\n";
+    }
+    json += "  ]\n}\n";
+    return json;
+}
+
+// Reads back the subset of our own output format needed for comparisons: name -> ns_per_op.
+std::unordered_map<std::string, f64> parse_baseline(const std::string& text)
+{
+    std::unordered_map<std::string, f64> baseline;
+
+    constexpr std::string_view name_key{ "\"name\": \"" };
+    constexpr std::string_view ns_key{ "\"ns_per_op\": " };
+
+    std::size_t pos{ 0u };
+    while ((pos = text.find(name_key, pos)) != std::string::npos)
+    {
+        pos += name_key.size();
+        const std::size_t name_end{ text.find('"', pos) };
+        const std::size_t entry_end{ text.find('}', pos) };
+        if (name_end == std::string::npos || entry_end == std::string::npos)
+            break;
+
+        const std::size_t ns_pos{ text.find(ns_key, name_end) };
+        if (ns_pos != std::string::npos && ns_pos < entry_end)
+            baseline[text.substr(pos, name_end - pos)] = std::strtod(text.c_str() + ns_pos + ns_key.size(), nullptr);
+
+        pos = entry_end;
+    }
+
+    return baseline;
+}
+
+// Returns the number of benchmarks that regressed beyond the threshold.
+u32 compare(const std::vector<Result>& results, const std::unordered_map<std::string, f64>& baseline, f64 threshold)
+{
+    u32 regressions{ 0u };
+
+    fmt::print(stderr, "{:<40} {:>14} {:>14} {:>9}\n", "benchmark", "baseline ns", "current ns", "delta");
+    for (const auto& r : results)
+    {
+        auto it{ baseline.find(r.name) };
+        if (!r.skip_reason.empty() || it == baseline.end() || it->second <= 0.0)
+        {
+            fmt::print(stderr, "{:<40} {:>14} {:>14} {:>9}\n", r.name, "-", "-", "n/a");
+            continue;
+        }
+
+        const f64 delta{ (r.ns_per_op - it->second) / it->second };
+        const bool regressed{ delta > threshold };
+        regressions += regressed;
+
+        fmt::print(stderr, "{:<40} {:>14.2f} {:>14.2f} {:>+8.1f}%{}\n", r.name, it->second, r.ns_per_op, delta * 100.0,
+                   regressed ? "  REGRESSION" : "");
+    }
+
+    return regressions;
+}
+
+void print_usage(const char* argv0)
+{
+    fmt::print(stderr,
+               "Usage: {} [options]\n"
+               "  --filter <substr>     Only run benchmarks whose name contains <substr>\n"
+               "  --out <file>          Write JSON results to <file> instead of stdout\n"
+               "  --baseline <file>     Compare against a previous JSON run, exit 1 on regressions\n"
+               "  --threshold <ratio>   Allowed slowdown before a result counts as a regression (default 0.10)\n"
+               "  --min-time <seconds>  Minimum duration of a calibrated run (default 0.2)\n"
+               "  --repetitions <n>     Number of measured runs per benchmark (default 5)\n"
+               "  --list                List registered benchmarks and exit\n",
+               argv0);
+}
+
+} // namespace
+
+} // namespace Surreal::Bench
+
+int main(int argc, char** argv)
+{
+    using namespace Surreal::Bench;
+
+    Options opts;
+    bool list_only{ false };
+
+    for (int i{ 1 }; i < argc; ++i)
+    {
+        const std::string_view arg{ argv[i] };
+        const bool has_value{ i + 1 < argc };
+
+        if (arg == "--filter" && has_value)
+            opts.filter = argv[++i];
+        else if (arg == "--out" && has_value)
+            opts.out_path = argv[++i];
+        else if (arg == "--baseline" && has_value)
+            opts.baseline_path = argv[++i];
+        else if (arg == "--threshold" && has_value)
+            opts.threshold = std::strtod(argv[++i], nullptr);
+        else if (arg == "--min-time" && has_value)
+            opts.min_time = std::strtod(argv[++i], nullptr);
+        else if (arg == "--repetitions" && has_value)
+            opts.repetitions = std::max(1u, static_cast<Surreal::u32>(std::strtoul(argv[++i], nullptr, 10)));
+        else if (arg == "--list")
+            list_only = true;
+        else
+        {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const auto& bench : registry())
+    {
+        if (!opts.filter.empty() && !std::strstr(bench.name, opts.filter.c_str()))
+            continue;
+
+        if (list_only)
+        {
+            fmt::print("{}\n", bench.name);
+            continue;
+        }
+
+        results.push_back(run(bench, opts));
+        const auto& r{ results.back() };
+        if (r.skip_reason.empty())
+            fmt::print(stderr, "{:<40} {:>14.2f} ns/op ({} iterations)\n", r.name, r.ns_per_op, r.iterations);
+        else
+            fmt::print(stderr, "{:<40} skipped: {}\n", r.name, r.skip_reason);
+    }
+
+    if (list_only)
+        return 0;
+
+    const std::string json{ to_json(results) };
+    if (opts.out_path.empty())
+        fmt::print("{}", json);
+    else
+    {
+        std::ofstream out{ opts.out_path };
+        if (!out)
+        {
+            fmt::print(stderr, "Failed to open {} for writing.\n", opts.out_path);
+            return 2;
+        }
+        out << json;
+    }
+
+    if (!opts.baseline_path.empty())
+    {
+        std::ifstream in{ opts.baseline_path };
+        if (!in)
+        {
+            fmt::print(stderr, "Failed to open baseline {}.\n", opts.baseline_path);
+            return 2;
+        }
+
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        if (compare(results, parse_baseline(buffer.str()), opts.threshold))
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "bench.hpp"
+
+#include <core/math.hpp>
+
+#include <random>
+#include <vector>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+constexpr std::size_t s_object_count{ 1u << 20u };
+constexpr std::size_t s_block_count{ s_object_count / 8u };
+
+// Objects scattered in a 200 m cube around a camera looking down -z, so only some of them are visible.
+struct Scene
+{
+    Scene() : points(s_object_count), boxes(s_object_count), wide_points(s_block_count), wide_boxes(s_block_count)
+    {
+        std::mt19937 rng{ 42u };
+        std::uniform_real_distribution<f32> coordinate{ -100.0f, 100.0f };
+        std::uniform_real_distribution<f32> extent{ 0.25f, 2.0f };
+
+        for (std::size_t i{ 0u }; i < s_object_count; ++i)
+        {
+            points[i] = { coordinate(rng), coordinate(rng), coordinate(rng) };
+            const Vec3 e{ extent(rng), extent(rng), extent(rng) };
+            boxes[i] = { points[i] - e, points[i] + e };
+        }
+
+        for (std::size_t block{ 0u }; block < s_block_count; ++block)
+        {
+            wide_points[block] = Vec3x8::load(&points[block * 8u]);
+
+            Vec3 centers[8], extents[8];
+            for (std::size_t lane{ 0u }; lane < 8u; ++lane)
+            {
+                centers[lane] = boxes[block * 8u + lane].get_center();
+                extents[lane] = boxes[block * 8u + lane].get_extents();
+            }
+            wide_boxes[block] = { Vec3x8::load(centers), Vec3x8::load(extents) };
+        }
+
+        const Mat4 view{ Mat4::look_at({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f }) };
+        frustum = Frustum::from_matrix(Mat4::perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) * view);
+        model = Mat4::trs({ 1.0f, 2.0f, 3.0f }, Quat::from_axis_angle({ 0.0f, 1.0f, 0.0f }, 0.5f), { 2.0f, 2.0f, 2.0f });
+    }
+
+    std::vector<Vec3> points;
+    std::vector<AABB> boxes;
+    std::vector<Vec3x8> wide_points;
+    std::vector<AABBx8> wide_boxes;
+    Frustum frustum;
+    Mat4 model;
+};
+
+Scene& get_scene()
+{
+    static Scene scene;
+    return scene;
+}
+
+void math_transform_1m_scalar(State& state)
+{
+    Scene& scene{ get_scene() };
+    std::vector<Vec3> out(s_object_count);
+
+    while (state.keep_running())
+    {
+        for (std::size_t i{ 0u }; i < s_object_count; ++i)
+            out[i] = transform_point(scene.model, scene.points[i]);
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(math_transform_1m_scalar);
+
+void math_transform_1m_wide(State& state)
+{
+    Scene& scene{ get_scene() };
+    std::vector<Vec3x8> out(s_block_count);
+
+    while (state.keep_running())
+    {
+        transform_points(scene.model, scene.wide_points, out);
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(math_transform_1m_wide);
+
+void math_cull_1m_scalar(State& state)
+{
+    Scene& scene{ get_scene() };
+    std::vector<u8> visible(s_object_count);
+
+    while (state.keep_running())
+    {
+        for (std::size_t i{ 0u }; i < s_object_count; ++i)
+            visible[i] = scene.frustum.test(scene.boxes[i]);
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(math_cull_1m_scalar);
+
+void math_cull_1m_wide(State& state)
+{
+    Scene& scene{ get_scene() };
+    std::vector<u8> visible(s_block_count);
+
+    while (state.keep_running())
+    {
+        std::size_t count{ cull(scene.frustum, std::span<const AABBx8>(scene.wide_boxes), s_object_count, visible) };
+        do_not_optimize(count);
+    }
+}
+SURREAL_BENCHMARK(math_cull_1m_wide);
+
+} // namespace
+
+} // namespace Surreal::Bench
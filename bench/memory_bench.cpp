@@ -0,0 +1,86 @@
+#include "bench.hpp"
+
+#include <core/memory.hpp>
+
+#include <array>
+#include <unordered_map>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+constexpr u32 s_batch{ 1024u };
+constexpr u32 s_map_size{ 10000u };
+
+// Allocate a batch, then free it, so the allocator has to both hand out and take back blocks.
+void memory_small_new_delete(State& state)
+{
+    std::array<void*, s_batch> ptrs;
+    while (state.keep_running())
+    {
+        for (void*& ptr : ptrs)
+            ptr = ::operator new(48u);
+        clobber_memory();
+        for (void* ptr : ptrs)
+            ::operator delete(ptr, 48u);
+    }
+}
+SURREAL_BENCHMARK(memory_small_new_delete);
+
+void memory_small_tagged(State& state)
+{
+    std::array<void*, s_batch> ptrs;
+    while (state.keep_running())
+    {
+        for (void*& ptr : ptrs)
+            ptr = Memory::allocate(48u, alignof(std::max_align_t), MemoryTag::Core);
+        clobber_memory();
+        for (void* ptr : ptrs)
+            Memory::deallocate(ptr, 48u, alignof(std::max_align_t), MemoryTag::Core);
+    }
+}
+SURREAL_BENCHMARK(memory_small_tagged);
+
+template <typename Map>
+void fill_and_clear(State& state)
+{
+    Map map;
+    while (state.keep_running())
+    {
+        for (u32 i{ 0u }; i < s_map_size; ++i)
+            map.emplace(i, i);
+        clobber_memory();
+        map.clear();
+    }
+}
+
+void memory_map_churn_std(State& state)
+{
+    fill_and_clear<std::unordered_map<u32, u32>>(state);
+}
+SURREAL_BENCHMARK(memory_map_churn_std);
+
+void memory_map_churn_tagged(State& state)
+{
+    fill_and_clear<TaggedUnorderedMap<u32, u32, MemoryTag::Core>>(state);
+}
+SURREAL_BENCHMARK(memory_map_churn_tagged);
+
+// A frame's worth of merging: what check_budgets() costs Application every frame.
+void memory_check_budgets(State& state)
+{
+    Memory::set_budget(MemoryTag::Core, u64{ 1u } << 40u);
+    while (state.keep_running())
+    {
+        u32 over{ Memory::check_budgets() };
+        do_not_optimize(over);
+    }
+    Memory::set_budget(MemoryTag::Core, 0u);
+}
+SURREAL_BENCHMARK(memory_check_budgets);
+
+} // namespace
+
+} // namespace Surreal::Bench
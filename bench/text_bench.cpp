@@ -0,0 +1,110 @@
+#include "bench.hpp"
+
+#include <core/text.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+constexpr u32 s_line_count{ 200u };
+
+// SURREAL_BENCH_FONT overrides the default, which is where most distributions install DejaVu.
+std::unique_ptr<Font> load_font(State& state)
+{
+    const char* env{ std::getenv("SURREAL_BENCH_FONT") };
+    const std::string path{ env ? env : "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf" };
+    if (!std::filesystem::exists(path))
+    {
+        state.skip("no font at " + path + " (set SURREAL_BENCH_FONT)");
+        return nullptr;
+    }
+    return std::make_unique<Font>(path, 14u);
+}
+
+std::vector<std::string> make_overlay()
+{
+    std::vector<std::string> lines;
+    for (u32 i{ 0u }; i < s_line_count; ++i)
+        lines.push_back(fmt::format("counter {:3}: {:10.3f} ms  {:8} events  {:6} handled", i, i * 0.37, i * 131u, i));
+    return lines;
+}
+
+void draw_overlay(TextRenderer& text, Font& font, const std::vector<std::string>& lines)
+{
+    text.begin_frame();
+    for (u32 i{ 0u }; i < lines.size(); ++i)
+        text.draw(font, lines[i], 4, static_cast<i32>(i) * font.get_line_height(), make_pixel(255u, 255u, 255u));
+}
+
+// The same overlay every frame, which should reuse the previous batch.
+void text_overlay_unchanged_200(State& state)
+{
+    const std::unique_ptr<Font> font{ load_font(state) };
+    if (!font)
+        return;
+
+    const std::vector<std::string> lines{ make_overlay() };
+    TextRenderer text;
+    while (state.keep_running())
+    {
+        draw_overlay(text, *font, lines);
+        bool changed{ text.end_frame().changed };
+        do_not_optimize(changed);
+    }
+}
+SURREAL_BENCHMARK(text_overlay_unchanged_200);
+
+// One line changes every frame: shaping is cached for the others, but the batch is rebuilt.
+void text_overlay_one_line_changing_200(State& state)
+{
+    const std::unique_ptr<Font> font{ load_font(state) };
+    if (!font)
+        return;
+
+    std::vector<std::string> lines{ make_overlay() };
+    TextRenderer text;
+    u64 frame{ 0u };
+    while (state.keep_running())
+    {
+        lines[0] = fmt::format("frame {}", frame++ % 1000u);
+        draw_overlay(text, *font, lines);
+        bool changed{ text.end_frame().changed };
+        do_not_optimize(changed);
+    }
+}
+SURREAL_BENCHMARK(text_overlay_one_line_changing_200);
+
+void text_render_200(State& state)
+{
+    const std::unique_ptr<Font> font{ load_font(state) };
+    if (!font)
+        return;
+
+    const std::vector<std::string> lines{ make_overlay() };
+    TextRenderer text;
+    draw_overlay(text, *font, lines);
+    text.end_frame();
+
+    Surface surface;
+    surface.resize({ 1280u, 200u * static_cast<u32>(font->get_line_height()) });
+    while (state.keep_running())
+    {
+        text.render(surface);
+        clobber_memory();
+    }
+}
+SURREAL_BENCHMARK(text_render_200);
+
+} // namespace
+
+} // namespace Surreal::Bench
@@ -0,0 +1,39 @@
+#include "bench.hpp"
+
+#include <core/topology.hpp>
+
+namespace Surreal::Bench
+{
+
+namespace
+{
+
+// What Application pays once at startup to read sysfs.
+void topology_detect(State& state)
+{
+    while (state.keep_running())
+    {
+        CpuTopology topology{ CpuTopology::detect() };
+        u32 count{ topology.get_cpu_count() };
+        do_not_optimize(count);
+    }
+}
+SURREAL_BENCHMARK(topology_detect);
+
+void topology_build_plan(State& state)
+{
+    const CpuTopology topology{ CpuTopology::detect() };
+    AffinityPolicy policy;
+    policy.enabled = true;
+    while (state.keep_running())
+    {
+        AffinityPlan plan{ AffinityPlan::build(topology, policy) };
+        u32 count{ plan.get_worker_count() };
+        do_not_optimize(count);
+    }
+}
+SURREAL_BENCHMARK(topology_build_plan);
+
+} // namespace
+
+} // namespace Surreal::Bench
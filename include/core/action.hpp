@@ -0,0 +1,189 @@
+#pragma once
+
+#include "base.hpp"
+#include "event.hpp"
+#include "exception.hpp"
+#include "input.hpp"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Surreal
+{
+
+typedef u16 ActionId;
+typedef u16 AxisId;
+
+class ActionError : public LogicError
+{
+public:
+    explicit ActionError(const std::string& msg) : LogicError(msg) {}
+};
+
+// Declarative description of actions, axes and what they are bound to. Ids are assigned in declaration order and
+// stay valid for any ActionBindings built with the same declarations.
+class ActionBindings
+{
+public:
+    ActionId add_action(std::string name);
+    AxisId add_axis(std::string name);
+
+    // Modifier bindings are exact: a binding for Ctrl+S does not trigger on Ctrl+Shift+S, and S alone does not
+    // trigger on Ctrl+S.
+    void bind(ActionId action, Key key, ModifierFlags modifiers = {});
+    void bind(ActionId action, MouseButton button, ModifierFlags modifiers = {});
+    // Axis value is the sum of the scales of every bound key that is down.
+    void bind_axis(AxisId axis, Key key, f32 scale);
+
+    ActionId find_action(std::string_view name) const;
+    AxisId find_axis(std::string_view name) const;
+
+    std::size_t get_action_count() const noexcept { return m_action_names.size(); }
+    std::size_t get_axis_count() const noexcept { return m_axis_names.size(); }
+
+private:
+    friend class ActionTable;
+
+    struct KeyBinding
+    {
+        ActionId action;
+        Key key;
+        ModifierFlags modifiers;
+    };
+
+    struct ButtonBinding
+    {
+        ActionId action;
+        MouseButton button;
+        ModifierFlags modifiers;
+    };
+
+    struct AxisBinding
+    {
+        AxisId axis;
+        Key key;
+        f32 scale;
+    };
+
+    std::vector<std::string> m_action_names;
+    std::vector<std::string> m_axis_names;
+    std::vector<KeyBinding> m_key_bindings;
+    std::vector<ButtonBinding> m_button_bindings;
+    std::vector<AxisBinding> m_axis_bindings;
+};
+
+// Bindings compiled into per-key and per-button ranges of a flat array, so resolving an event is an index lookup.
+class ActionTable
+{
+public:
+    explicit ActionTable(const ActionBindings& bindings);
+
+    struct Target
+    {
+        u16 index;
+        ModifierFlags modifiers;
+    };
+
+    struct AxisTarget
+    {
+        AxisId axis;
+        f32 scale;
+    };
+
+    std::span<const Target> get_key_targets(Key key) const noexcept
+    {
+        const auto i{ static_cast<std::size_t>(key) };
+        return { m_key_targets.data() + m_key_offsets[i], m_key_targets.data() + m_key_offsets[i + 1u] };
+    }
+
+    std::span<const Target> get_button_targets(MouseButton button) const noexcept
+    {
+        const auto i{ static_cast<std::size_t>(button) };
+        return { m_button_targets.data() + m_button_offsets[i], m_button_targets.data() + m_button_offsets[i + 1u] };
+    }
+
+    std::span<const AxisTarget> get_axis_targets(Key key) const noexcept
+    {
+        const auto i{ static_cast<std::size_t>(key) };
+        return { m_axis_targets.data() + m_axis_offsets[i], m_axis_targets.data() + m_axis_offsets[i + 1u] };
+    }
+
+    // Target::index refers to the binding, these map it to its action.
+    constexpr std::span<const ActionId> get_binding_actions() const noexcept { return m_binding_actions; }
+
+    constexpr std::size_t get_action_count() const noexcept { return m_action_count; }
+    constexpr std::size_t get_axis_count() const noexcept { return m_axis_count; }
+
+private:
+    static constexpr std::size_t s_key_count{ static_cast<std::size_t>(Key::Count) };
+    static constexpr std::size_t s_button_count{ static_cast<std::size_t>(MouseButton::Unknown) + 1u };
+
+    std::array<u32, s_key_count + 1u> m_key_offsets;
+    std::array<u32, s_button_count + 1u> m_button_offsets;
+    std::array<u32, s_key_count + 1u> m_axis_offsets;
+
+    std::vector<Target> m_key_targets;
+    std::vector<Target> m_button_targets;
+    std::vector<AxisTarget> m_axis_targets;
+    std::vector<ActionId> m_binding_actions;
+
+    std::size_t m_action_count;
+    std::size_t m_axis_count;
+};
+
+struct ActionState
+{
+    bool down;
+    bool pressed;
+    bool released;
+};
+
+// Resolves key and button events to actions through an ActionTable. Register it as an event handler and call
+// begin_frame() once per frame before the window drains its events.
+class ActionMap final : public EventHandler
+{
+public:
+    ActionMap();
+
+    // Compiles the bindings on the calling thread; the new table is picked up by the next begin_frame().
+    // Actions that are down when the table is swapped are released.
+    void set_bindings(const ActionBindings& bindings);
+
+    void begin_frame();
+
+    constexpr std::span<const ActionState> get_states() const noexcept { return m_states; }
+    constexpr const ActionState& get(ActionId action) const noexcept { return m_states[action]; }
+    constexpr std::span<const f32> get_axes() const noexcept { return m_axis_values; }
+    constexpr f32 get_axis(AxisId axis) const noexcept { return m_axis_values[axis]; }
+
+    void operator()(KeyEvent&) override;
+    void operator()(MouseEvent&) override;
+    void operator()(WindowEvent&) override;
+
+private:
+    void swap_table(std::shared_ptr<const ActionTable> table);
+    void activate(std::span<const ActionTable::Target> targets);
+    void deactivate(std::span<const ActionTable::Target> targets);
+    ModifierFlags get_modifiers() const noexcept;
+
+    std::shared_ptr<const ActionTable> m_table;
+
+    std::vector<ActionState> m_states;
+    std::vector<f32> m_axis_values;
+    // Per binding, whether its press was matched; per action, how many of its bindings are held.
+    std::vector<u8> m_binding_active;
+    std::vector<u16> m_active_counts;
+
+    // Physical key state as seen by this map; outlives table swaps so held keys keep feeding axes.
+    KeyboardState m_keys;
+
+    std::mutex m_pending_mutex;
+    std::shared_ptr<const ActionTable> m_pending_table;
+};
+
+} // namespace Surreal
@@ -1,34 +1,88 @@
 #pragma once
 
+#include "action.hpp"
 #include "base.hpp"
+#include "capture.hpp"
+#include "ecs.hpp"
 #include "event.hpp"
+#include "memory.hpp"
+#include "system.hpp"
+#include "thread_pool.hpp"
+#include "topology.hpp"
 #include "window.hpp"
 
+#include <memory>
+#include <optional>
+
 namespace Surreal
 {
 
 class Application : public EventHandler
 {
 public:
-    Application();
+    SURREAL_TAGGED_NEW(MemoryTag::App)
+
+    // The policy decides where the main loop, the workers and the other framework threads run; the thread pool is
+    // sized from it.
+    explicit Application(const AffinityPolicy& policy = {});
     virtual ~Application();
 
     void run();
 
-    void on_update(float delta_time);
+    virtual void on_update(float delta_time);
 
     void operator()(KeyEvent&) override;
+    void operator()(MouseEvent&) override;
     void operator()(WindowEvent&) override;
 
     // void process_key_event(KeyEvent&) override;
     // void process_window_event(WindowEvent&) override;
 
+protected:
+    void quit() noexcept { m_should_quit = true; }
+
+    const KeyboardState& get_keyboard() const noexcept { return m_window->get_keyboard(); }
+    ActionMap& get_actions() noexcept { return m_actions; }
+    // Presented after the systems have run. While capturing, see start_capture() for when it must be redrawn.
+    Surface& get_surface() noexcept { return m_window->get_surface(); }
+
+    const AffinityPlan& get_affinity() const noexcept { return m_affinity; }
+    ThreadPool& get_thread_pool() noexcept { return m_thread_pool; }
+    World& get_world() noexcept { return m_world; }
+    // Systems run after on_update() every frame.
+    SystemScheduler& get_systems() noexcept { return m_systems; }
+
+    // Records every presented frame to a file until stop_capture(). Called before run(), the capture starts with the
+    // window. Each presented frame is traded to the capture rather than copied, leaving the surface stale: from then
+    // on, draw it in full whenever get_surface().needs_redraw() is set, even on frames where nothing changed. It is
+    // neither presented nor recorded again until then. A file holds frames of one size, so when the window is resized
+    // the recording carries on in a new file next to it: capture.qoi, then capture.1.qoi, capture.2.qoi and so on.
+    // Throws FileError if the file cannot be created.
+    void start_capture(const CaptureSettings& settings);
+    // Waits for the frames already submitted to be written.
+    void stop_capture();
+    // Null when not capturing.
+    const FrameCapture* get_capture() const noexcept { return m_capture.get(); }
+
+private:
+    void restart_capture(Size size);
+
 private:
     static Application* s_instance;
 
 private:
     bool m_should_quit;
     Window* m_window;
+    ActionMap m_actions;
+
+    AffinityPlan m_affinity;
+    ThreadPool m_thread_pool;
+    World m_world;
+    SystemScheduler m_systems;
+
+    std::optional<CaptureSettings> m_capture_settings;
+    std::unique_ptr<FrameCapture> m_capture;
+    u32 m_capture_segment;
 };
 
 } // namespace Surreal
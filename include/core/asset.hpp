@@ -0,0 +1,225 @@
+#pragma once
+
+#include "base.hpp"
+#include "exception.hpp"
+#include "file.hpp"
+#include "memory.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Surreal
+{
+
+class AssetError : public RuntimeError
+{
+public:
+    explicit AssetError(const std::string& msg) : RuntimeError(msg) {}
+};
+
+enum struct AssetCompression : u8
+{
+    None,
+    Lz4,
+};
+
+// Pack layout, little-endian:
+//   PackHeader
+//   PackEntry[entry_count], sorted by name_hash
+//   names, not NUL-terminated
+//   blobs, each starting on a multiple of alignment
+// Raw blobs are page-aligned at the default alignment, so a mapped blob can be handed straight to an upload.
+struct PackHeader
+{
+    static constexpr u32 s_magic{ 0x4b415053u }; // "SPAK"
+    static constexpr u16 s_version{ 1u };
+
+    u32 magic;
+    u16 version;
+    u16 reserved0;
+    u32 entry_count;
+    u32 alignment;
+    u64 toc_offset;
+    u64 names_offset;
+    u64 names_size;
+    u64 data_offset;
+    u8 reserved1[16];
+};
+
+struct PackEntry
+{
+    u64 name_hash;
+    u64 offset;
+    // Bytes in the pack; equal to size for uncompressed entries.
+    u64 stored_size;
+    u64 size;
+    u32 name_offset;
+    u16 name_length;
+    AssetCompression compression;
+    u8 reserved[9];
+};
+
+static_assert(sizeof(PackHeader) == 64u && sizeof(PackEntry) == 48u);
+
+// FNV-1a, so names can be hashed at compile time.
+constexpr u64 hash_asset_name(std::string_view name) noexcept
+{
+    u64 hash{ 0xcbf29ce484222325u };
+    for (char c : name)
+        hash = (hash ^ static_cast<u8>(c)) * 0x100000001b3u;
+    return hash;
+}
+
+// A mapped pack. Raw entries are returned as views into the mapping without copying.
+class AssetPack
+{
+public:
+    // Throws FileError if the file cannot be mapped and AssetError if it is not a valid pack.
+    explicit AssetPack(const std::string& path);
+
+    const PackEntry* find(std::string_view name) const noexcept;
+
+    constexpr std::span<const PackEntry> get_entries() const noexcept { return m_entries; }
+    std::string_view get_name(const PackEntry& entry) const noexcept;
+
+    // The entry's bytes as stored; the asset itself for uncompressed entries.
+    std::span<const u8> get_stored(const PackEntry& entry) const noexcept;
+
+    // Synchronous load, decompressing if needed. Prefer AssetStreamer on the frame thread.
+    std::vector<u8> load(const PackEntry& entry) const;
+
+    const MappedFile& get_file() const noexcept { return m_file; }
+
+private:
+    MappedFile m_file;
+    std::span<const PackEntry> m_entries;
+    std::string_view m_names;
+};
+
+// Collects assets and writes them out as a pack.
+class AssetPackBuilder
+{
+public:
+    explicit AssetPackBuilder(u32 alignment = 4096u);
+
+    // Throws AssetError on a duplicate name or hash collision.
+    void add(std::string name, std::vector<u8> data, AssetCompression compression = AssetCompression::Lz4);
+
+    // Compresses on the pool. Entries that do not shrink are stored raw.
+    void write(const std::string& path, ThreadPool& pool) const;
+
+    std::size_t get_entry_count() const noexcept { return m_assets.size(); }
+
+private:
+    struct Asset
+    {
+        std::string name;
+        u64 hash;
+        std::vector<u8> data;
+        AssetCompression compression;
+    };
+
+    u32 m_alignment;
+    std::vector<Asset> m_assets;
+};
+
+typedef u64 StreamRequestId;
+
+enum struct StreamStatus : u8
+{
+    Completed,
+    Failed,
+};
+
+struct StreamResult
+{
+    StreamRequestId id;
+    const PackEntry* entry;
+    StreamStatus status;
+    // The asset: a view into the pack for raw entries, otherwise into storage. Callbacks may move storage out.
+    std::span<const u8> data;
+    std::vector<u8> storage;
+    std::string error;
+};
+
+// Loads pack entries in the background, highest priority first. Compressed entries are read through an AsyncReader
+// and decompressed on the pool; raw entries are prefetched in the mapping. Callbacks run on the thread calling
+// poll(), which is also the thread that must call request() and cancel().
+class AssetStreamer
+{
+public:
+    typedef std::function<void(StreamResult&)> Callback;
+
+    AssetStreamer(const AssetPack& pack, ThreadPool& pool, u32 max_in_flight = 32u);
+    ~AssetStreamer();
+
+    AssetStreamer(const AssetStreamer&) = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+    StreamRequestId request(const PackEntry& entry, i32 priority, Callback on_complete);
+
+    // Returns true if the callback will not run. Work already under way is finished and discarded.
+    bool cancel(StreamRequestId id);
+
+    // Runs the callbacks of finished requests; returns how many ran.
+    u32 poll();
+
+    u32 get_pending_count() const noexcept { return static_cast<u32>(m_callbacks.size()); }
+    const char* get_reader_name() const noexcept { return m_reader->get_name(); }
+
+private:
+    struct Request
+    {
+        StreamRequestId id;
+        const PackEntry* entry;
+        i32 priority;
+        std::atomic<bool> cancelled{ false };
+        TaggedVector<u8, MemoryTag::Assets> buffer;
+    };
+
+    typedef std::shared_ptr<Request> RequestPtr;
+
+    static bool is_lower_priority(const RequestPtr& a, const RequestPtr& b) noexcept;
+
+    void io_loop();
+    void dispatch_reads();
+    void on_read(const RequestPtr& request, i32 error);
+    void finish(const RequestPtr& request, StreamResult result);
+
+    const AssetPack& m_pack;
+    ThreadPool& m_pool;
+    const u32 m_max_in_flight;
+    std::unique_ptr<AsyncReader> m_reader;
+
+    // Owned by the polling thread.
+    TaggedUnorderedMap<StreamRequestId, std::pair<RequestPtr, Callback>, MemoryTag::Assets> m_callbacks;
+    StreamRequestId m_next_id;
+
+    // Shared with the I/O thread.
+    std::mutex m_queue_mutex;
+    std::condition_variable m_queue_signal;
+    TaggedVector<RequestPtr, MemoryTag::Assets> m_queue; // Max-heap on (priority, -id).
+    bool m_stopping;
+
+    // Owned by the I/O thread.
+    TaggedUnorderedMap<StreamRequestId, RequestPtr, MemoryTag::Assets> m_in_flight;
+
+    std::mutex m_done_mutex;
+    std::condition_variable m_done_signal;
+    std::vector<StreamResult> m_done;
+    u32 m_decompressing;
+
+    std::thread m_io_thread;
+};
+
+} // namespace Surreal
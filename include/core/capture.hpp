@@ -0,0 +1,172 @@
+#pragma once
+
+#include "base.hpp"
+#include "exception.hpp"
+#include "file.hpp"
+#include "memory.hpp"
+#include "surface.hpp"
+#include "thread_pool.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Surreal
+{
+
+class CaptureError : public RuntimeError
+{
+public:
+    explicit CaptureError(const std::string& msg) : RuntimeError(msg) {}
+};
+
+enum struct CaptureFormat : u8
+{
+    // Frames as they are in memory, B, G, R, A per pixel, back to back (ffmpeg: -f rawvideo -pixel_format bgra).
+    Raw,
+    // YUV4MPEG2 with full-range BT.601 4:2:0 chroma, which most players and encoders read directly.
+    Y4m,
+    // One QOI image (RGB) per frame, back to back. Lossless and usually a quarter of raw or less for UI content.
+    Qoi,
+};
+
+constexpr std::string_view to_string(CaptureFormat format) noexcept
+{
+    constexpr std::string_view names[]{ "raw", "y4m", "qoi" };
+    return names[static_cast<u8>(format)];
+}
+
+// What submit() does when the writer is behind: every frame buffer is still being encoded or written, or the queue
+// of frames waiting for the writer is full.
+enum struct CaptureOverflow : u8
+{
+    // Wait for room, slowing the frame loop down to what the disk sustains.
+    Block,
+    // Leave the frame out of the recording, so the frame loop never waits and the disk gets no more than it sustains.
+    Drop,
+};
+
+struct CaptureSettings
+{
+    std::string path;
+    CaptureFormat format{ CaptureFormat::Qoi };
+    CaptureOverflow overflow{ CaptureOverflow::Drop };
+    // Only written into the Y4M header; frames are recorded one per submit().
+    u32 frame_rate{ 60u };
+    // Frames that can be in flight between submit() and the disk.
+    u32 buffer_count{ 4u };
+    // Bypass the page cache, so a long recording does not evict everything else.
+    bool direct_io{ true };
+};
+
+struct CaptureStats
+{
+    u64 submitted;
+    // Frames recorded by repeating the previous one because the surface had not changed.
+    u64 repeated;
+    // Frames left out because the writer was behind, or because the surface had been resized.
+    u64 dropped;
+    u64 written;
+    u64 bytes_written;
+};
+
+// Records a surface to a file. submit() swaps the surface's pixels for a free frame buffer instead of copying them;
+// color conversion and compression run on the thread pool, or on the writer thread when the pool has no workers, and
+// the writer thread appends the frames in order through an AsyncWriter in large aligned chunks. Frames must keep the
+// size the capture was started with.
+class FrameCapture
+{
+public:
+    // Throws CaptureError if frame_size is empty and FileError if the output file cannot be created.
+    FrameCapture(const CaptureSettings& settings, Size frame_size, ThreadPool& pool);
+    // Waits for every submitted frame to reach the file.
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Records the surface's current contents as the next frame. Call it after presenting: a surface that changed is
+    // left holding an older frame, with needs_redraw() set, and has to be redrawn in full before it is presented
+    // again. A surface that has not been drawn since the last call, or is still stale, is recorded as a repeat without
+    // touching it. Returns false if the frame was dropped.
+    bool submit(Surface& surface);
+
+    CaptureStats get_stats() const;
+    constexpr const CaptureSettings& get_settings() const noexcept { return m_settings; }
+    constexpr Size get_frame_size() const noexcept { return m_frame_size; }
+    const char* get_writer_name() const noexcept { return m_writer->get_name(); }
+
+private:
+    struct Frame
+    {
+        std::vector<Pixel> pixels;
+        // Sized for the worst case once, so encoding never allocates; encoded_size bytes of it are used.
+        TaggedVector<u8, MemoryTag::Capture> encoded;
+        std::size_t encoded_size;
+        bool ready;
+    };
+
+    struct Chunk
+    {
+        u8* data;
+        bool busy;
+    };
+
+    static constexpr u32 s_repeat{ ~0u };
+
+    void push_pending(u32 index) noexcept;
+    u32 pop_pending() noexcept;
+    void encode(Frame& frame) const;
+    void write_loop();
+    void append(std::span<const u8> bytes);
+    void flush_chunk();
+    bool reap();
+    void finish_file();
+
+    const CaptureSettings m_settings;
+    const Size m_frame_size;
+    ThreadPool& m_pool;
+    // Set when the pool would run encode tasks inline on the frame loop.
+    const bool m_encode_on_writer;
+    OutputFile m_file;
+    std::unique_ptr<AsyncWriter> m_writer;
+
+    // Owned by the submitting thread.
+    u64 m_last_revision;
+    bool m_has_frame;
+    bool m_size_warned;
+
+    // Shared with the workers and the writer thread.
+    mutable std::mutex m_mutex;
+    std::condition_variable m_frame_ready;
+    // A frame buffer or a pending slot was freed.
+    std::condition_variable m_space_free;
+    std::vector<Frame> m_frames;
+    TaggedVector<u32, MemoryTag::Capture> m_free_frames;
+    // Frame indices, or s_repeat, in submission order: a ring with room for two entries per frame buffer, which bounds
+    // how many repeats can wait for the writer.
+    TaggedVector<u32, MemoryTag::Capture> m_pending;
+    u32 m_pending_head;
+    u32 m_pending_count;
+    CaptureStats m_stats;
+    bool m_stopping;
+
+    // Owned by the writer thread.
+    std::vector<Chunk> m_chunks;
+    u32 m_chunk;
+    std::size_t m_chunk_fill;
+    u64 m_file_offset;
+    TaggedVector<u8, MemoryTag::Capture> m_last_encoded;
+    std::size_t m_last_size;
+    std::vector<IoCompletion> m_completions;
+    bool m_failed;
+
+    std::thread m_write_thread;
+};
+
+} // namespace Surreal
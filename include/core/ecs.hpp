@@ -0,0 +1,550 @@
+#pragma once
+
+#include "base.hpp"
+#include "exception.hpp"
+#include "thread_pool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Surreal
+{
+
+typedef u32 ComponentId;
+
+class EcsError : public LogicError
+{
+public:
+    explicit EcsError(const std::string& msg) : LogicError(msg) {}
+};
+
+struct Entity
+{
+    u32 index;
+    u32 generation;
+
+    constexpr bool operator==(const Entity&) const noexcept = default;
+};
+
+inline constexpr Entity s_null_entity{ ~0u, ~0u };
+
+// Type-erased operations on a component type, so archetypes and command buffers can move components around
+// without knowing their types.
+struct ComponentInfo
+{
+    u32 size;
+    u32 alignment;
+    // Move-constructs into dst and destroys src.
+    void (*relocate)(void* dst, void* src);
+    void (*destroy)(void* ptr);
+};
+
+class ComponentMask
+{
+public:
+    static constexpr u32 s_max_components{ 256u };
+
+    constexpr void set(ComponentId id) noexcept { m_words[id / 64u] |= u64(1) << (id % 64u); }
+    constexpr void reset(ComponentId id) noexcept { m_words[id / 64u] &= ~(u64(1) << (id % 64u)); }
+    constexpr bool test(ComponentId id) const noexcept { return m_words[id / 64u] & (u64(1) << (id % 64u)); }
+
+    constexpr bool contains(const ComponentMask& that) const noexcept
+    {
+        for (std::size_t i{ 0u }; i < s_word_count; ++i)
+            if ((m_words[i] & that.m_words[i]) != that.m_words[i])
+                return false;
+        return true;
+    }
+
+    constexpr bool intersects(const ComponentMask& that) const noexcept
+    {
+        for (std::size_t i{ 0u }; i < s_word_count; ++i)
+            if (m_words[i] & that.m_words[i])
+                return true;
+        return false;
+    }
+
+    constexpr ComponentMask operator|(const ComponentMask& that) const noexcept
+    {
+        ComponentMask result{ *this };
+        for (std::size_t i{ 0u }; i < s_word_count; ++i)
+            result.m_words[i] |= that.m_words[i];
+        return result;
+    }
+
+    constexpr bool operator==(const ComponentMask&) const noexcept = default;
+
+    struct Hash
+    {
+        std::size_t operator()(const ComponentMask& mask) const noexcept
+        {
+            u64 h{ 0xcbf29ce484222325u };
+            for (u64 word : mask.m_words)
+                h = (h ^ word) * 0x100000001b3u;
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+private:
+    static constexpr std::size_t s_word_count{ s_max_components / 64u };
+
+    std::array<u64, s_word_count> m_words{};
+};
+
+namespace Detail
+{
+
+ComponentId register_component(const ComponentInfo& info);
+
+template <typename Tp>
+ComponentId component_id_impl()
+{
+    static_assert(std::is_nothrow_move_constructible_v<Tp>, "Components must be nothrow move constructible.");
+
+    static const ComponentId s_id{ register_component({
+        static_cast<u32>(sizeof(Tp)),
+        static_cast<u32>(alignof(Tp)),
+        [](void* dst, void* src) {
+            new (dst) Tp(std::move(*static_cast<Tp*>(src)));
+            static_cast<Tp*>(src)->~Tp();
+        },
+        [](void* ptr) { static_cast<Tp*>(ptr)->~Tp(); },
+    }) };
+    return s_id;
+}
+
+template <typename... Ts>
+constexpr bool are_unique() noexcept
+{
+    if constexpr (sizeof...(Ts) <= 1u)
+        return true;
+    else
+        return []<typename Head, typename... Tail>(std::type_identity<Head>, std::type_identity<Tail>...) {
+            return (!std::is_same_v<Head, Tail> && ...) && are_unique<Tail...>();
+        }(std::type_identity<std::remove_cv_t<Ts>>()...);
+}
+
+} // namespace Detail
+
+template <typename Tp>
+ComponentId component_id()
+{
+    return Detail::component_id_impl<std::remove_cvref_t<Tp>>();
+}
+
+const ComponentInfo& get_component_info(ComponentId id);
+
+template <typename... Ts>
+ComponentMask make_component_mask()
+{
+    ComponentMask mask;
+    (mask.set(component_id<Ts>()), ...);
+    return mask;
+}
+
+// Entities with the same set of components. Rows live in fixed-size chunks; within a chunk each component type
+// is one contiguous, cache-line aligned array. All chunks but the last are full.
+class Archetype
+{
+public:
+    static constexpr u32 s_chunk_bytes{ 16u * 1024u };
+    static constexpr u16 s_no_column{ 0xffffu };
+
+    Archetype(const ComponentMask& mask, std::vector<ComponentId> ids);
+    ~Archetype();
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    constexpr const ComponentMask& get_mask() const noexcept { return m_mask; }
+    constexpr std::span<const ComponentId> get_ids() const noexcept { return m_ids; }
+
+    constexpr u32 get_size() const noexcept { return m_size; }
+    constexpr u32 get_chunk_capacity() const noexcept { return m_capacity; }
+    // Chunks holding at least one row; a spare empty chunk may be allocated past these.
+    constexpr u32 get_chunk_count() const noexcept { return (m_size + m_capacity - 1u) / m_capacity; }
+    constexpr u32 get_chunk_size(u32 chunk) const noexcept
+    {
+        const u32 first{ chunk * m_capacity };
+        return m_size - first < m_capacity ? m_size - first : m_capacity;
+    }
+
+    u16 get_column(ComponentId id) const noexcept { return m_columns[id]; }
+
+    Entity* get_entities(u32 chunk) const noexcept { return reinterpret_cast<Entity*>(m_chunks[chunk]); }
+
+    void* get_column_data(u32 chunk, u16 column) const noexcept { return m_chunks[chunk] + m_offsets[column]; }
+
+    template <typename Tp>
+    Tp* get_column_data(u32 chunk, u16 column) const noexcept
+    {
+        return std::launder(reinterpret_cast<Tp*>(get_column_data(chunk, column)));
+    }
+
+    void* get_component(u32 row, u16 column) const noexcept
+    {
+        return m_chunks[row / m_capacity] + m_offsets[column] +
+               static_cast<std::size_t>(row % m_capacity) * m_sizes[column];
+    }
+
+    Entity get_entity(u32 row) const noexcept { return get_entities(row / m_capacity)[row % m_capacity]; }
+
+    // Reserves a row for the entity; its components are left uninitialized.
+    u32 allocate_row(Entity entity);
+    // Fills the hole at row with the last row. The row's components must already be destroyed or relocated.
+    // Returns the entity that now occupies row, or s_null_entity if row was the last one.
+    Entity remove_row(u32 row);
+
+private:
+    friend class World;
+
+    // Cached archetype graph edges for adding/removing a single component.
+    std::unordered_map<ComponentId, Archetype*> m_add_edges;
+    std::unordered_map<ComponentId, Archetype*> m_remove_edges;
+
+    ComponentMask m_mask;
+    std::vector<ComponentId> m_ids;
+    std::vector<u32> m_sizes;
+    std::vector<u32> m_offsets;
+    std::array<u16, ComponentMask::s_max_components> m_columns;
+
+    std::vector<u8*> m_chunks;
+    u32 m_capacity;
+    u32 m_size;
+};
+
+class World;
+
+// Structural changes recorded while iterating and applied by World::flush(). Components are moved into stable
+// arena storage until then.
+class CommandBuffer
+{
+public:
+    CommandBuffer() = default;
+    ~CommandBuffer();
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    template <typename... Ts>
+    void create(Ts&&... components)
+    {
+        static_assert(Detail::are_unique<std::remove_cvref_t<Ts>...>(), "Duplicate component types.");
+
+        const u32 first{ static_cast<u32>(m_payloads.size()) };
+        (push_payload(std::forward<Ts>(components)), ...);
+        m_commands.push_back({ Op::Create, s_null_entity, first, static_cast<u32>(sizeof...(Ts)) });
+    }
+
+    void destroy(Entity entity) { m_commands.push_back({ Op::Destroy, entity, 0u, 0u }); }
+
+    template <typename Tp>
+    void add(Entity entity, Tp&& component)
+    {
+        const u32 first{ static_cast<u32>(m_payloads.size()) };
+        push_payload(std::forward<Tp>(component));
+        m_commands.push_back({ Op::Add, entity, first, 1u });
+    }
+
+    template <typename Tp>
+    void remove(Entity entity)
+    {
+        m_payloads.push_back({ component_id<Tp>(), nullptr });
+        m_commands.push_back({ Op::Remove, entity, static_cast<u32>(m_payloads.size() - 1u), 0u });
+    }
+
+    bool empty() const noexcept { return m_commands.empty(); }
+
+    // Destroys any payloads that were not consumed and drops all commands.
+    void clear() noexcept;
+
+private:
+    friend class World;
+
+    enum struct Op : u8
+    {
+        Create,
+        Destroy,
+        Add,
+        Remove,
+    };
+
+    struct Command
+    {
+        Op op;
+        Entity entity;
+        u32 first_payload;
+        u32 payload_count;
+    };
+
+    struct Payload
+    {
+        ComponentId id;
+        // Null once the component has been moved out, or for Remove commands.
+        void* data;
+    };
+
+    template <typename Tp>
+    void push_payload(Tp&& component)
+    {
+        typedef std::remove_cvref_t<Tp> ValueTp;
+        void* storage{ allocate(sizeof(ValueTp), alignof(ValueTp)) };
+        new (storage) ValueTp(std::forward<Tp>(component));
+        m_payloads.push_back({ component_id<ValueTp>(), storage });
+    }
+
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    static constexpr std::size_t s_block_size{ 64u * 1024u };
+
+    struct alignas(64) Block
+    {
+        std::byte bytes[s_block_size];
+    };
+
+    std::vector<Command> m_commands;
+    std::vector<Payload> m_payloads;
+    std::vector<std::unique_ptr<Block>> m_blocks;
+    std::size_t m_block_used{ s_block_size };
+    std::size_t m_blocks_in_use{ 0u };
+};
+
+template <typename... Ts>
+class Query;
+
+class World
+{
+public:
+    World();
+    ~World();
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    template <typename... Ts>
+    Entity create(Ts&&... components)
+    {
+        static_assert(Detail::are_unique<std::remove_cvref_t<Ts>...>(), "Duplicate component types.");
+
+        Archetype* archetype{ get_archetype(make_component_mask<std::remove_cvref_t<Ts>...>()) };
+        const Entity entity{ allocate_entity() };
+        const u32 row{ archetype->allocate_row(entity) };
+        m_records[entity.index].archetype = archetype;
+        m_records[entity.index].row = row;
+
+        (new (archetype->get_component(row, archetype->get_column(component_id<Ts>())))
+             std::remove_cvref_t<Ts>(std::forward<Ts>(components)),
+         ...);
+        return entity;
+    }
+
+    void destroy(Entity entity);
+
+    bool is_alive(Entity entity) const noexcept
+    {
+        return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation &&
+               m_records[entity.index].archetype;
+    }
+
+    // Replaces the component if the entity already has one.
+    template <typename Tp>
+    void add(Entity entity, Tp&& component)
+    {
+        typedef std::remove_cvref_t<Tp> ValueTp;
+        if (ValueTp* existing{ get<ValueTp>(entity) })
+        {
+            *existing = std::forward<Tp>(component);
+            return;
+        }
+
+        void* slot{ add_uninitialized(entity, component_id<ValueTp>()) };
+        new (slot) ValueTp(std::forward<Tp>(component));
+    }
+
+    template <typename Tp>
+    void remove(Entity entity)
+    {
+        remove(entity, component_id<Tp>());
+    }
+
+    // Returns nullptr if the entity does not have the component.
+    template <typename Tp>
+    Tp* get(Entity entity) const
+    {
+        const auto& record{ get_record(entity) };
+        const u16 column{ record.archetype->get_column(component_id<Tp>()) };
+        if (column == Archetype::s_no_column)
+            return nullptr;
+        return std::launder(static_cast<Tp*>(record.archetype->get_component(record.row, column)));
+    }
+
+    template <typename Tp>
+    bool has(Entity entity) const
+    {
+        return get_record(entity).archetype->get_mask().test(component_id<Tp>());
+    }
+
+    template <typename... Ts>
+    Query<Ts...> query()
+    {
+        return Query<Ts...>(*this);
+    }
+
+    // Applies the recorded commands in order. Commands on entities that died in the meantime are skipped.
+    void flush(CommandBuffer& commands);
+
+    constexpr u32 get_entity_count() const noexcept { return m_entity_count; }
+    constexpr const std::vector<std::unique_ptr<Archetype>>& get_archetypes() const noexcept { return m_archetypes; }
+
+private:
+    struct EntityRecord
+    {
+        Archetype* archetype;
+        u32 row;
+        u32 generation;
+    };
+
+    const EntityRecord& get_record(Entity entity) const;
+    Entity allocate_entity();
+    Archetype* get_archetype(const ComponentMask& mask);
+    Archetype* get_add_target(Archetype* source, ComponentId id);
+    Archetype* get_remove_target(Archetype* source, ComponentId id);
+    // Moves the entity to target, relocating shared components and destroying the ones target lacks.
+    void move_entity(Entity entity, Archetype* target);
+    void* add_uninitialized(Entity entity, ComponentId id);
+    void remove(Entity entity, ComponentId id);
+    void create(std::span<CommandBuffer::Payload> payloads);
+
+    std::vector<EntityRecord> m_records;
+    std::vector<u32> m_free_indices;
+    u32 m_entity_count;
+
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    std::unordered_map<ComponentMask, Archetype*, ComponentMask::Hash> m_archetype_lookup;
+};
+
+// Iterates every entity that has all of Ts. Const component types are read-only, which is what the system
+// scheduler uses to decide which systems may run concurrently. The set of matching archetypes is cached and only
+// extended when the world gains new archetypes.
+template <typename... Ts>
+class Query
+{
+public:
+    static_assert(sizeof...(Ts) > 0u, "A query needs at least one component type.");
+    static_assert(Detail::are_unique<std::remove_cv_t<Ts>...>(), "Duplicate component types.");
+
+    explicit Query(World& world) : m_world(&world), m_mask(make_component_mask<Ts...>()), m_matches(), m_work(), m_seen(0u)
+    {
+    }
+
+    static ComponentMask get_reads() { return make_component_mask<Ts...>(); }
+
+    static ComponentMask get_writes()
+    {
+        ComponentMask mask;
+        ((std::is_const_v<Ts> ? void() : mask.set(component_id<Ts>())), ...);
+        return mask;
+    }
+
+    // func(u32 count, const Entity* entities, Ts*... columns) once per chunk.
+    template <typename FuncTp>
+    void each_chunk(FuncTp&& func)
+    {
+        update_matches();
+        for (const auto& match : m_matches)
+            for (u32 chunk{ 0u }; chunk < match.archetype->get_chunk_count(); ++chunk)
+                call_chunk(match, chunk, func, std::index_sequence_for<Ts...>());
+    }
+
+    // func(Ts&... components) once per entity.
+    template <typename FuncTp>
+    void each(FuncTp&& func)
+    {
+        each_chunk([&func](u32 count, const Entity*, Ts*... columns) {
+            for (u32 i{ 0u }; i < count; ++i)
+                func(columns[i]...);
+        });
+    }
+
+    // func(Entity, Ts&... components) once per entity.
+    template <typename FuncTp>
+    void each_entity(FuncTp&& func)
+    {
+        each_chunk([&func](u32 count, const Entity* entities, Ts*... columns) {
+            for (u32 i{ 0u }; i < count; ++i)
+                func(entities[i], columns[i]...);
+        });
+    }
+
+    // Like each(), with chunks spread across the pool. func must be safe to call concurrently.
+    template <typename FuncTp>
+    void parallel_each(ThreadPool& pool, FuncTp&& func)
+    {
+        update_matches();
+
+        m_work.clear();
+        for (u32 m{ 0u }; m < m_matches.size(); ++m)
+            for (u32 chunk{ 0u }; chunk < m_matches[m].archetype->get_chunk_count(); ++chunk)
+                m_work.push_back({ m, chunk });
+
+        pool.parallel_for(static_cast<u32>(m_work.size()), [&](u32 i) {
+            call_chunk(m_matches[m_work[i].match], m_work[i].chunk,
+                       [&func](u32 count, const Entity*, Ts*... columns) {
+                           for (u32 j{ 0u }; j < count; ++j)
+                               func(columns[j]...);
+                       },
+                       std::index_sequence_for<Ts...>());
+        });
+    }
+
+private:
+    struct Match
+    {
+        Archetype* archetype;
+        std::array<u16, sizeof...(Ts)> columns;
+    };
+
+    struct WorkItem
+    {
+        u32 match;
+        u32 chunk;
+    };
+
+    void update_matches()
+    {
+        const auto& archetypes{ m_world->get_archetypes() };
+        for (; m_seen < archetypes.size(); ++m_seen)
+        {
+            Archetype* archetype{ archetypes[m_seen].get() };
+            if (archetype->get_mask().contains(m_mask))
+                m_matches.push_back({ archetype, { archetype->get_column(component_id<Ts>())... } });
+        }
+    }
+
+    template <typename FuncTp, std::size_t... Is>
+    static void call_chunk(const Match& match, u32 chunk, FuncTp&& func, std::index_sequence<Is...>)
+    {
+        const u32 count{ match.archetype->get_chunk_size(chunk) };
+        if (!count)
+            return;
+
+        func(count, match.archetype->get_entities(chunk),
+             match.archetype->template get_column_data<std::remove_cv_t<Ts>>(chunk, match.columns[Is])...);
+    }
+
+    World* m_world;
+    ComponentMask m_mask;
+    std::vector<Match> m_matches;
+    std::vector<WorkItem> m_work;
+    std::size_t m_seen;
+};
+
+} // namespace Surreal
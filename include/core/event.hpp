@@ -1,7 +1,9 @@
 #pragma once
 
 #include "base.hpp"
+#include "input.hpp"
 
+#include <span>
 #include <string>
 
 #include <fmt/format.h>
@@ -35,6 +37,11 @@ enum struct EventType : u32
 {
     KeyPress,
     KeyRelease,
+    MouseButtonPress,
+    MouseButtonRelease,
+    MouseMove,
+    MouseScroll,
+    MouseRawMotion,
     WindowClose,
     WindowPosition,
     WindowResize,
@@ -159,39 +166,200 @@ public:
 
     SURREAL_DECLARE_EVENT_CATEGORIES(EventCategoryFlagBits::Keyboard);
 
-    constexpr u32 get_key() const noexcept { return m_key; }
+    constexpr Key get_key() const noexcept { return m_key; }
+    // Platform keycode, for bindings to keys that have no Key value.
+    constexpr u32 get_scancode() const noexcept { return m_scancode; }
 
-    std::string to_string() const noexcept { return fmt::format("{}: {}", get_name(), m_key); }
+    std::string to_string() const noexcept
+    {
+        return fmt::format("{}: {} ({})", get_name(), static_cast<u32>(m_key), m_scancode);
+    }
 
 protected:
-    KeyEvent(u32 key) : m_key(key) {}
+    KeyEvent(Key key, u32 scancode) : m_key(key), m_scancode(scancode) {}
 
 private:
-    u32 m_key;
+    Key m_key;
+    u32 m_scancode;
 };
 
 class KeyPressEvent final : public KeyEvent
 {
 public:
-    KeyPressEvent(u32 key) : KeyEvent(key) {}
+    KeyPressEvent(Key key, u32 scancode, bool repeat = false) : KeyEvent(key, scancode), m_repeat(repeat) {}
 
     SURREAL_DECLARE_EVENT_TYPE(KeyPress);
+
+    // True for auto-repeat presses of a key that is held down.
+    constexpr bool is_repeat() const noexcept { return m_repeat; }
+
+private:
+    bool m_repeat;
 };
 
 class KeyReleaseEvent final : public KeyEvent
 {
 public:
-    KeyReleaseEvent(u32 key) : KeyEvent(key) {}
+    KeyReleaseEvent(Key key, u32 scancode) : KeyEvent(key, scancode) {}
 
     SURREAL_DECLARE_EVENT_TYPE(KeyRelease);
 };
 
+enum struct MouseButton : u8
+{
+    Left,
+    Middle,
+    Right,
+    Back,
+    Forward,
+    Unknown,
+};
+
+// Handle to a region of a HitRegions index. Stale handles are detected through the generation.
+struct HitRegion
+{
+    u32 index;
+    u32 generation;
+
+    constexpr bool operator==(const HitRegion&) const noexcept = default;
+};
+
+inline constexpr HitRegion s_null_region{ ~0u, ~0u };
+
+// Unaccelerated device motion, in device units.
+struct MouseRawSample
+{
+    f32 dx, dy;
+    u32 time;
+};
+
+class MouseEvent : public Event
+{
+public:
+    virtual ~MouseEvent() = default;
+
+    SURREAL_DECLARE_EVENT_CATEGORIES(EventCategoryFlagBits::Mouse);
+
+    constexpr u64 get_id() const noexcept { return m_id; }
+
+    // The region the event was routed to, or s_null_region when it is going through the handler stack.
+    constexpr HitRegion get_region() const noexcept { return m_region; }
+    constexpr void set_region(HitRegion region) noexcept { m_region = region; }
+
+protected:
+    MouseEvent(u64 id) : m_id(id), m_region(s_null_region) {}
+
+private:
+    u64 m_id;
+    HitRegion m_region;
+};
+
+class MouseButtonEvent : public MouseEvent
+{
+public:
+    virtual ~MouseButtonEvent() = default;
+
+    constexpr MouseButton get_button() const noexcept { return m_button; }
+    constexpr const Position& get_position() const noexcept { return m_pos; }
+
+    std::string to_string() const noexcept
+    {
+        return fmt::format("{}: {} at ({}, {})", get_name(), static_cast<u32>(m_button), m_pos.x, m_pos.y);
+    }
+
+protected:
+    MouseButtonEvent(u64 id, MouseButton button, Position pos) : MouseEvent(id), m_button(button), m_pos(pos) {}
+
+private:
+    MouseButton m_button;
+    Position m_pos;
+};
+
+class MouseButtonPressEvent final : public MouseButtonEvent
+{
+public:
+    MouseButtonPressEvent(u64 id, MouseButton button, Position pos) : MouseButtonEvent(id, button, pos) {}
+
+    SURREAL_DECLARE_EVENT_TYPE(MouseButtonPress);
+};
+
+class MouseButtonReleaseEvent final : public MouseButtonEvent
+{
+public:
+    MouseButtonReleaseEvent(u64 id, MouseButton button, Position pos) : MouseButtonEvent(id, button, pos) {}
+
+    SURREAL_DECLARE_EVENT_TYPE(MouseButtonRelease);
+};
+
+// Pointer position in window coordinates. Core motion is coalesced, so this is sent at most once per frame.
+class MouseMoveEvent final : public MouseEvent
+{
+public:
+    MouseMoveEvent(u64 id, Position pos) : MouseEvent(id), m_pos(pos) {}
+
+    SURREAL_DECLARE_EVENT_TYPE(MouseMove);
+
+    constexpr const Position& get_position() const noexcept { return m_pos; }
+
+    std::string to_string() const noexcept { return fmt::format("{}: ({}, {})", get_name(), m_pos.x, m_pos.y); }
+
+private:
+    Position m_pos;
+};
+
+// Wheel steps; positive dy scrolls up, positive dx scrolls right.
+class MouseScrollEvent final : public MouseEvent
+{
+public:
+    MouseScrollEvent(u64 id, f32 dx, f32 dy, Position pos) : MouseEvent(id), m_dx(dx), m_dy(dy), m_pos(pos) {}
+
+    SURREAL_DECLARE_EVENT_TYPE(MouseScroll);
+
+    constexpr f32 get_dx() const noexcept { return m_dx; }
+    constexpr f32 get_dy() const noexcept { return m_dy; }
+    constexpr const Position& get_position() const noexcept { return m_pos; }
+
+    std::string to_string() const noexcept { return fmt::format("{}: ({}, {})", get_name(), m_dx, m_dy); }
+
+private:
+    f32 m_dx, m_dy;
+    Position m_pos;
+};
+
+// Every raw motion sample received during one frame. The samples are only valid for the duration of the call.
+class MouseRawMotionEvent final : public MouseEvent
+{
+public:
+    MouseRawMotionEvent(u64 id, std::span<const MouseRawSample> samples) : MouseEvent(id), m_samples(samples) {}
+
+    SURREAL_DECLARE_EVENT_TYPE(MouseRawMotion);
+
+    constexpr std::span<const MouseRawSample> get_samples() const noexcept { return m_samples; }
+
+    constexpr MouseRawSample get_total() const noexcept
+    {
+        MouseRawSample total{ 0.0f, 0.0f, m_samples.empty() ? 0u : m_samples.back().time };
+        for (const auto& sample : m_samples)
+        {
+            total.dx += sample.dx;
+            total.dy += sample.dy;
+        }
+        return total;
+    }
+
+    std::string to_string() const noexcept { return fmt::format("{}: {} samples", get_name(), m_samples.size()); }
+
+private:
+    std::span<const MouseRawSample> m_samples;
+};
+
 class EventHandler
 {
 public:
     virtual ~EventHandler() = default;
 
     virtual void operator()(KeyEvent&) = 0;
+    virtual void operator()(MouseEvent&) = 0;
     virtual void operator()(WindowEvent&) = 0;
 
     // virtual void process_key_event(KeyEvent&) = 0;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "base.hpp"
+#include "exception.hpp"
+#include "thread_pool.hpp"
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Surreal
+{
+
+#if SURREAL_PLATFORM_LINUX
+typedef int FileHandle;
+#endif
+
+class FileError : public RuntimeError
+{
+public:
+    explicit FileError(const std::string& msg) : RuntimeError(msg) {}
+};
+
+// Read-only mapping of a whole file. Pages are faulted in on first access.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    constexpr std::span<const u8> get_bytes() const noexcept { return { m_data, m_size }; }
+    constexpr FileHandle get_handle() const noexcept { return m_handle; }
+
+    // Asks the kernel to start reading the range in, so a later access does not block on a page fault.
+    void prefetch(u64 offset, u64 size) const noexcept;
+
+private:
+    FileHandle m_handle;
+    const u8* m_data;
+    std::size_t m_size;
+};
+
+// File opened for sequential writing, created or truncated. With direct I/O the page cache is bypassed, and every
+// write must start at an offset, come from an address and cover a length aligned to s_direct_alignment.
+class OutputFile
+{
+public:
+    static constexpr std::size_t s_direct_alignment{ 4096u };
+
+    // Falls back to buffered I/O if the file system refuses direct I/O. Throws FileError if the file cannot be opened.
+    OutputFile(const std::string& path, bool direct);
+    ~OutputFile();
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    constexpr FileHandle get_handle() const noexcept { return m_handle; }
+    constexpr bool is_direct() const noexcept { return m_direct; }
+
+    // Cuts off the padding of a final aligned write.
+    void truncate(u64 size);
+
+private:
+    FileHandle m_handle;
+    bool m_direct;
+};
+
+struct IoCompletion
+{
+    u64 user;
+    // 0, or the errno of the failed operation.
+    i32 error;
+};
+
+// Queue of file reads completed off the calling thread. read() and wait() belong to a single thread; wake() may be
+// called from any thread.
+class AsyncReader
+{
+public:
+    typedef IoCompletion Completion;
+
+    virtual ~AsyncReader() = default;
+
+    // Fills all of buffer from offset. Short reads are continued internally, so a completion without an error means
+    // the whole buffer was read.
+    virtual void read(FileHandle file, u64 offset, std::span<u8> buffer, u64 user) = 0;
+
+    // Blocks until at least one read has completed or wake() was called, and appends the completions to out.
+    virtual void wait(std::vector<Completion>& out) = 0;
+
+    virtual void wake() noexcept = 0;
+
+    virtual const char* get_name() const noexcept = 0;
+
+    // io_uring when the kernel supports it and SURREAL_USE_IO_URING is set, otherwise blocking reads on the pool.
+    static std::unique_ptr<AsyncReader> create(ThreadPool& pool, u32 queue_depth);
+};
+
+// The write side of AsyncReader, with the same threading rules.
+class AsyncWriter
+{
+public:
+    typedef IoCompletion Completion;
+
+    virtual ~AsyncWriter() = default;
+
+    // Writes all of buffer at offset. The buffer must stay alive and unchanged until its completion is returned.
+    virtual void write(FileHandle file, u64 offset, std::span<const u8> buffer, u64 user) = 0;
+
+    virtual void wait(std::vector<Completion>& out) = 0;
+
+    virtual void wake() noexcept = 0;
+
+    virtual const char* get_name() const noexcept = 0;
+
+    // io_uring when the kernel supports it and SURREAL_USE_IO_URING is set, otherwise blocking writes on the pool.
+    static std::unique_ptr<AsyncWriter> create(ThreadPool& pool, u32 queue_depth);
+};
+
+} // namespace Surreal
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "base.hpp"
+#include "event.hpp"
+#include "exception.hpp"
+#include "memory.hpp"
+
+namespace Surreal
+{
+
+class HitTestError : public LogicError
+{
+public:
+    explicit HitTestError(const std::string& msg) : LogicError(msg) {}
+};
+
+// Screen rectangles owned by event handlers, for routing pointer events to the topmost one under the pointer.
+// Regions are bucketed into a uniform grid of square cells over the window, so a query only looks at the regions
+// overlapping one cell, and each cell keeps its regions topmost first: higher layer, then most recently added or
+// raised. Moving or resizing a region only touches the cells it enters or leaves. Not thread-safe.
+class HitRegions
+{
+public:
+    static constexpr u32 s_default_cell_size{ 64u };
+
+    explicit HitRegions(Size bounds = {}, u32 cell_size = s_default_cell_size);
+
+    // Throws HitTestError if owner is null.
+    HitRegion add(EventHandler* owner, Rect rect, i32 layer = 0);
+    // The functions taking a region throw HitTestError if it has been removed.
+    void remove(HitRegion region);
+    void clear();
+
+    void set_rect(HitRegion region, Rect rect);
+    void set_layer(HitRegion region, i32 layer);
+    // Puts the region above the others on its layer.
+    void raise(HitRegion region);
+    // Disabled regions stay indexed but are skipped, so whatever is below them gets the pointer.
+    void set_enabled(HitRegion region, bool enabled);
+
+    bool is_alive(HitRegion region) const noexcept;
+    Rect get_rect(HitRegion region) const;
+    EventHandler* get_owner(HitRegion region) const;
+    constexpr u32 get_region_count() const noexcept { return m_region_count; }
+
+    // The window size the grid covers; nothing outside it can be hit. Rebuilds every cell, so it is meant for window
+    // resizes, before the handlers lay their regions out again.
+    void set_bounds(Size bounds);
+    constexpr Size get_bounds() const noexcept { return m_bounds; }
+
+    // Topmost enabled region containing pos, or s_null_region.
+    HitRegion hit_test(Position pos) const noexcept;
+
+    // Sends a pointer event to the owner of the topmost region at pos, with the region set on the event, and returns
+    // whether the owner marked it handled. The region a button went down in captures the pointer: it gets the moves
+    // and the release until the last button is up, wherever the pointer is.
+    bool route(MouseEvent& e, Position pos);
+
+private:
+    struct Record
+    {
+        Rect rect;
+        EventHandler* owner;
+        i32 layer;
+        // Position in the add/raise order of the layer; larger is on top.
+        u64 sequence;
+        u32 generation;
+        bool alive;
+        bool enabled;
+    };
+
+    // Half-open range of cells, empty when x0 == x1 or y0 == y1.
+    struct CellRange
+    {
+        u32 x0, y0, x1, y1;
+
+        constexpr bool contains(u32 x, u32 y) const noexcept { return x >= x0 && x < x1 && y >= y0 && y < y1; }
+    };
+
+    Record& get_record(HitRegion region);
+    const Record& get_record(HitRegion region) const;
+
+    CellRange get_cells(Rect rect) const noexcept;
+    bool is_above(u32 a, u32 b) const noexcept;
+    void insert(u32 index, CellRange range, CellRange skip);
+    void erase(u32 index, CellRange range, CellRange skip) noexcept;
+
+    TaggedVector<Record, MemoryTag::Events> m_records;
+    TaggedVector<u32, MemoryTag::Events> m_free_indices;
+    TaggedVector<TaggedVector<u32, MemoryTag::Events>, MemoryTag::Events> m_cells;
+    Size m_bounds;
+    u32 m_cell_size;
+    u32 m_columns;
+    u32 m_rows;
+    u64 m_sequence;
+    u32 m_region_count;
+    HitRegion m_capture;
+    u32 m_captured_buttons;
+};
+
+} // namespace Surreal
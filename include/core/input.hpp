@@ -0,0 +1,135 @@
+#pragma once
+
+#include "base.hpp"
+
+#include <array>
+
+namespace Surreal
+{
+
+// Platform-neutral key identifiers. Keys are identified by the symbol the active layout gives them, not by position.
+enum struct Key : u16
+{
+    Unknown,
+
+    A, B, C, D, E, F, G, H, I, J, K, L, M, N, O, P, Q, R, S, T, U, V, W, X, Y, Z,
+    Num0, Num1, Num2, Num3, Num4, Num5, Num6, Num7, Num8, Num9,
+    F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+
+    Escape, Enter, Tab, Backspace, Space,
+    Minus, Equal, LeftBracket, RightBracket, Backslash, Semicolon, Apostrophe, Grave, Comma, Period, Slash,
+
+    Left, Right, Up, Down,
+    Insert, Delete, Home, End, PageUp, PageDown,
+
+    LeftShift, RightShift, LeftControl, RightControl, LeftAlt, RightAlt, LeftSuper, RightSuper,
+    CapsLock, NumLock, ScrollLock, PrintScreen, Pause, Menu,
+
+    Keypad0, Keypad1, Keypad2, Keypad3, Keypad4, Keypad5, Keypad6, Keypad7, Keypad8, Keypad9,
+    KeypadDecimal, KeypadDivide, KeypadMultiply, KeypadSubtract, KeypadAdd, KeypadEnter,
+
+    Count,
+};
+
+#define BIT(n) (1 << n)
+enum struct ModifierFlagBits : u32
+{
+    Shift = BIT(0),
+    Control = BIT(1),
+    Alt = BIT(2),
+    Super = BIT(3),
+};
+#undef BIT
+
+template <>
+struct FlagTraits<ModifierFlagBits>
+{
+    typedef ModifierFlagBits Bits;
+    typedef std::underlying_type<ModifierFlagBits>::type MaskType;
+
+    static constexpr MaskType AllFlags{ MaskType(Bits::Shift) | MaskType(Bits::Control) | MaskType(Bits::Alt) |
+                                        MaskType(Bits::Super) };
+};
+
+typedef Flags<ModifierFlagBits> ModifierFlags;
+
+// The modifier a key contributes while held, if any.
+constexpr ModifierFlags to_modifier(Key key) noexcept
+{
+    switch (key)
+    {
+    case Key::LeftShift:
+    case Key::RightShift:
+        return ModifierFlagBits::Shift;
+    case Key::LeftControl:
+    case Key::RightControl:
+        return ModifierFlagBits::Control;
+    case Key::LeftAlt:
+    case Key::RightAlt:
+        return ModifierFlagBits::Alt;
+    case Key::LeftSuper:
+    case Key::RightSuper:
+        return ModifierFlagBits::Super;
+    default:
+        return {};
+    }
+}
+
+// Key state as bitsets, so polling from simulation code is a single bit test.
+// pressed/released hold the transitions since the last begin_frame().
+class KeyboardState
+{
+public:
+    static constexpr std::size_t s_key_count{ static_cast<std::size_t>(Key::Count) };
+    static constexpr std::size_t s_word_count{ (s_key_count + 63u) / 64u };
+
+    typedef std::array<u64, s_word_count> Bits;
+
+    constexpr bool is_down(Key key) const noexcept { return test(m_down, key); }
+    constexpr bool was_pressed(Key key) const noexcept { return test(m_pressed, key); }
+    constexpr bool was_released(Key key) const noexcept { return test(m_released, key); }
+
+    constexpr const Bits& get_down() const noexcept { return m_down; }
+    constexpr const Bits& get_pressed() const noexcept { return m_pressed; }
+    constexpr const Bits& get_released() const noexcept { return m_released; }
+
+    constexpr void begin_frame() noexcept
+    {
+        m_pressed = {};
+        m_released = {};
+    }
+
+    // Returns false for repeats of a key that is already down.
+    constexpr bool press(Key key) noexcept
+    {
+        if (is_down(key))
+            return false;
+
+        set(m_down, key);
+        set(m_pressed, key);
+        return true;
+    }
+
+    constexpr void release(Key key) noexcept
+    {
+        if (!is_down(key))
+            return;
+
+        clear(m_down, key);
+        set(m_released, key);
+    }
+
+private:
+    static constexpr std::size_t word(Key key) noexcept { return static_cast<std::size_t>(key) / 64u; }
+    static constexpr u64 mask(Key key) noexcept { return u64(1) << (static_cast<std::size_t>(key) % 64u); }
+
+    static constexpr bool test(const Bits& bits, Key key) noexcept { return bits[word(key)] & mask(key); }
+    static constexpr void set(Bits& bits, Key key) noexcept { bits[word(key)] |= mask(key); }
+    static constexpr void clear(Bits& bits, Key key) noexcept { bits[word(key)] &= ~mask(key); }
+
+    Bits m_down{};
+    Bits m_pressed{};
+    Bits m_released{};
+};
+
+} // namespace Surreal
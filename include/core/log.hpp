@@ -0,0 +1,364 @@
+#pragma once
+
+#include "base.hpp"
+#include "exception.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+// Severity filtering happens in the preprocessor: a disabled level expands to nothing and its arguments are never
+// evaluated. SURREAL_LOG_LEVEL is provided by the build and defaults to Info.
+#define SURREAL_LOG_LEVEL_TRACE 0
+#define SURREAL_LOG_LEVEL_DEBUG 1
+#define SURREAL_LOG_LEVEL_INFO 2
+#define SURREAL_LOG_LEVEL_WARN 3
+#define SURREAL_LOG_LEVEL_ERROR 4
+#define SURREAL_LOG_LEVEL_CRITICAL 5
+#define SURREAL_LOG_LEVEL_OFF 6
+
+#ifndef SURREAL_LOG_LEVEL
+    #define SURREAL_LOG_LEVEL SURREAL_LOG_LEVEL_INFO
+#endif
+
+namespace Surreal
+{
+
+enum struct LogLevel : u8
+{
+    Trace = SURREAL_LOG_LEVEL_TRACE,
+    Debug = SURREAL_LOG_LEVEL_DEBUG,
+    Info = SURREAL_LOG_LEVEL_INFO,
+    Warn = SURREAL_LOG_LEVEL_WARN,
+    Error = SURREAL_LOG_LEVEL_ERROR,
+    Critical = SURREAL_LOG_LEVEL_CRITICAL,
+};
+
+constexpr std::string_view to_string(LogLevel level) noexcept
+{
+    constexpr std::string_view names[]{ "trace", "debug", "info", "warn", "error", "critical" };
+    return names[static_cast<u8>(level)];
+}
+
+class LogError : public RuntimeError
+{
+public:
+    explicit LogError(const std::string& msg) : RuntimeError(msg) {}
+};
+
+// Sinks only ever run on the logger's background thread.
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+
+    virtual void write(LogLevel level, std::string_view line) = 0;
+    virtual void flush() {}
+
+protected:
+    LogSink() = default;
+};
+
+class StderrLogSink final : public LogSink
+{
+public:
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+};
+
+class FileLogSink : public LogSink
+{
+public:
+    explicit FileLogSink(const std::string& path, bool truncate = false);
+    ~FileLogSink() override;
+
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+
+protected:
+    void open(bool truncate);
+    void close() noexcept;
+
+    std::string m_path;
+    std::FILE* m_file;
+    u64 m_size;
+};
+
+class RotatingFileLogSink final : public FileLogSink
+{
+public:
+    RotatingFileLogSink(const std::string& path, u64 max_bytes, u32 max_files);
+
+    void write(LogLevel level, std::string_view line) override;
+
+private:
+    void rotate();
+
+    u64 m_max_bytes;
+    u32 m_max_files;
+};
+
+namespace Detail
+{
+
+// Only ever named in an unevaluated context, so disabled log statements still count as uses of their arguments.
+template <typename... Args>
+int discard_log_args(Args&&...) noexcept;
+
+typedef void (*LogFormatFunc)(const u8* payload, const char* format, std::size_t format_size,
+                              fmt::memory_buffer& out);
+
+// Strings are copied into the record since the caller's storage may be gone by the time the record is formatted.
+// Everything else must be trivially copyable and is stored as raw bytes. encode() needs at least s_min_size bytes of
+// room, which encode_log_args() guarantees.
+template <typename Tp>
+struct LogArgCodec
+{
+    static_assert(std::is_trivially_copyable_v<Tp>, "Log arguments must be trivially copyable or string-like.");
+
+    typedef Tp Decoded;
+
+    static constexpr std::size_t s_min_size{ sizeof(Tp) };
+
+    static u8* encode(u8* out, SURREAL_UNUSED(const u8*, end), const Tp& value) noexcept
+    {
+        std::memcpy(out, &value, sizeof(Tp));
+        return out + sizeof(Tp);
+    }
+
+    static Decoded decode(const u8*& in) noexcept
+    {
+        std::array<u8, sizeof(Tp)> bytes;
+        std::memcpy(bytes.data(), in, sizeof(Tp));
+        in += sizeof(Tp);
+        return std::bit_cast<Tp>(bytes);
+    }
+};
+
+template <typename Tp>
+requires(std::is_convertible_v<const Tp&, std::string_view>) struct LogArgCodec<Tp>
+{
+    typedef std::string_view Decoded;
+
+    // The length prefix; the characters are cut to whatever room is left.
+    static constexpr std::size_t s_min_size{ 2u };
+
+    static u8* encode(u8* out, const u8* end, const Tp& value) noexcept
+    {
+        const std::string_view sv{ value };
+        const std::size_t room{ static_cast<std::size_t>(end - out - 2) };
+        const u16 size{ static_cast<u16>(std::min<std::size_t>({ sv.size(), room, 0xffffu })) };
+
+        std::memcpy(out, &size, 2);
+        std::memcpy(out + 2, sv.data(), size);
+        return out + 2 + size;
+    }
+
+    static Decoded decode(const u8*& in) noexcept
+    {
+        u16 size;
+        std::memcpy(&size, in, 2);
+        const std::string_view sv{ reinterpret_cast<const char*>(in + 2), size };
+        in += 2 + size;
+        return sv;
+    }
+};
+
+// Each argument only gets the room the ones after it do not need, so a long string is cut short instead of crowding
+// out the arguments that follow and leaving the formatter to decode bytes that were never written.
+template <typename... Args>
+u8* encode_log_args(u8* out, const u8* end, const Args&... args) noexcept
+{
+    std::size_t reserved{ (LogArgCodec<Args>::s_min_size + ... + 0u) };
+    ((reserved -= LogArgCodec<Args>::s_min_size, out = LogArgCodec<Args>::encode(out, end - reserved, args)), ...);
+    return out;
+}
+
+template <typename... Args>
+void format_log_record(const u8* payload, const char* format, std::size_t format_size, fmt::memory_buffer& out)
+{
+    // Braced initialization guarantees left-to-right evaluation, matching the encode order.
+    std::tuple<typename LogArgCodec<Args>::Decoded...> values{ LogArgCodec<Args>::decode(payload)... };
+    std::apply(
+        [&](auto&... decoded) {
+            fmt::vformat_to(std::back_inserter(out), std::string_view(format, format_size),
+                            fmt::make_format_args(decoded...));
+        },
+        values);
+}
+
+// The record keeps only a pointer to the format string, which has to outlive the background thread's formatting of
+// it. The constructor is consteval, so only string literals and other constants are accepted; a runtime string such
+// as fmt::runtime(std::string) fails to compile instead of being read after it has been freed.
+template <typename... Args>
+struct LogFormat
+{
+    template <typename Tp>
+    requires(std::is_convertible_v<const Tp&, std::string_view>) consteval LogFormat(const Tp& s) : format(s) {}
+
+    fmt::format_string<Args...> format;
+};
+
+struct alignas(64) LogRecord
+{
+    static constexpr std::size_t s_size{ 256u };
+    static constexpr std::size_t s_header_size{ 32u };
+
+    LogFormatFunc formatter;
+    const char* format;
+    u32 format_size;
+    LogLevel level;
+    i64 timestamp;
+    u8 payload[s_size - s_header_size];
+};
+static_assert(sizeof(LogRecord) == LogRecord::s_size);
+
+// Single-producer single-consumer ring of fixed-size records; one per logging thread.
+class LogRing
+{
+public:
+    static constexpr u64 s_capacity{ 1024u };
+
+    LogRecord* try_reserve() noexcept
+    {
+        const u64 tail{ m_tail.load(std::memory_order_relaxed) };
+        if (tail - m_cached_head >= s_capacity)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head >= s_capacity) SURREAL_UNLIKELY
+            {
+                m_dropped.fetch_add(1u, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        return &m_records[tail % s_capacity];
+    }
+
+    void commit() noexcept { m_tail.store(m_tail.load(std::memory_order_relaxed) + 1u, std::memory_order_release); }
+
+    const LogRecord* peek() const noexcept
+    {
+        const u64 head{ m_head.load(std::memory_order_relaxed) };
+        if (head == m_tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_records[head % s_capacity];
+    }
+
+    void pop() noexcept { m_head.store(m_head.load(std::memory_order_relaxed) + 1u, std::memory_order_release); }
+
+    u64 take_dropped() noexcept { return m_dropped.exchange(0u, std::memory_order_relaxed); }
+
+    void retire() noexcept { m_retired.store(true, std::memory_order_release); }
+    bool retired() const noexcept { return m_retired.load(std::memory_order_acquire); }
+
+private:
+    LogRecord m_records[s_capacity];
+
+    alignas(64) std::atomic<u64> m_head{ 0u };
+    alignas(64) std::atomic<u64> m_tail{ 0u };
+    u64 m_cached_head{ 0u };
+    std::atomic<u64> m_dropped{ 0u };
+    std::atomic<bool> m_retired{ false };
+};
+
+} // namespace Detail
+
+class Log
+{
+public:
+    Log() = delete;
+
+    // Starts the background thread. Records written before start() wait in their rings until then.
+    static void start();
+    // Drains every ring, flushes all sinks and joins the background thread.
+    static void stop();
+
+    // With no sinks registered, output goes to stderr.
+    static void add_sink(std::unique_ptr<LogSink> sink);
+
+    // Allocates the calling thread's ring up front, so the first log call on a hot thread does not.
+    static void register_thread() { thread_ring(); }
+
+    static u64 dropped_count() noexcept;
+
+    template <typename... Args>
+    static void write(LogLevel level, Detail::LogFormat<std::type_identity_t<Args>...> format, Args&&... args) noexcept
+    {
+        static_assert((Detail::LogArgCodec<std::decay_t<Args>>::s_min_size + ... + 0u) <=
+                          sizeof(Detail::LogRecord::payload),
+                      "Log arguments do not fit in a record.");
+
+        Detail::LogRing& ring{ thread_ring() };
+        Detail::LogRecord* record{ ring.try_reserve() };
+        if (!record) SURREAL_UNLIKELY
+            return;
+
+        const fmt::string_view format_view{ format.format };
+        record->formatter = &Detail::format_log_record<std::decay_t<Args>...>;
+        record->format = format_view.data();
+        record->format_size = static_cast<u32>(format_view.size());
+        record->level = level;
+        record->timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        Detail::encode_log_args<std::decay_t<Args>...>(record->payload, record->payload + sizeof(record->payload),
+                                                       args...);
+
+        ring.commit();
+    }
+
+private:
+    static Detail::LogRing& thread_ring();
+};
+
+} // namespace Surreal
+
+#define SURREAL_LOG(level, ...) ::Surreal::Log::write(::Surreal::LogLevel::level, __VA_ARGS__)
+#define SURREAL_LOG_DISABLED(...) static_cast<void>(sizeof(::Surreal::Detail::discard_log_args(__VA_ARGS__)))
+
+#if SURREAL_LOG_LEVEL <= SURREAL_LOG_LEVEL_TRACE
+    #define SURREAL_LOG_TRACE(...) SURREAL_LOG(Trace, __VA_ARGS__)
+#else
+    #define SURREAL_LOG_TRACE(...) SURREAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if SURREAL_LOG_LEVEL <= SURREAL_LOG_LEVEL_DEBUG
+    #define SURREAL_LOG_DEBUG(...) SURREAL_LOG(Debug, __VA_ARGS__)
+#else
+    #define SURREAL_LOG_DEBUG(...) SURREAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if SURREAL_LOG_LEVEL <= SURREAL_LOG_LEVEL_INFO
+    #define SURREAL_LOG_INFO(...) SURREAL_LOG(Info, __VA_ARGS__)
+#else
+    #define SURREAL_LOG_INFO(...) SURREAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if SURREAL_LOG_LEVEL <= SURREAL_LOG_LEVEL_WARN
+    #define SURREAL_LOG_WARN(...) SURREAL_LOG(Warn, __VA_ARGS__)
+#else
+    #define SURREAL_LOG_WARN(...) SURREAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if SURREAL_LOG_LEVEL <= SURREAL_LOG_LEVEL_ERROR
+    #define SURREAL_LOG_ERROR(...) SURREAL_LOG(Error, __VA_ARGS__)
+#else
+    #define SURREAL_LOG_ERROR(...) SURREAL_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if SURREAL_LOG_LEVEL <= SURREAL_LOG_LEVEL_CRITICAL
+    #define SURREAL_LOG_CRITICAL(...) SURREAL_LOG(Critical, __VA_ARGS__)
+#else
+    #define SURREAL_LOG_CRITICAL(...) SURREAL_LOG_DISABLED(__VA_ARGS__)
+#endif
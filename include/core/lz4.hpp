@@ -0,0 +1,25 @@
+#pragma once
+
+#include "base.hpp"
+
+#include <cstddef>
+#include <span>
+
+namespace Surreal
+{
+
+// LZ4 block format (no frame header), compatible with LZ4_compress_default() / LZ4_decompress_safe(). The
+// compressor is a single-pass greedy matcher tuned for fast decompression rather than ratio.
+
+constexpr std::size_t lz4_compress_bound(std::size_t size) noexcept { return size + size / 255u + 16u; }
+// The most a block of size bytes can decompress to: no sequence produces more than 255 bytes per input byte.
+constexpr u64 lz4_decompress_bound(u64 size) noexcept { return size * 255u; }
+
+// Returns the compressed size, or 0 if dst is smaller than lz4_compress_bound(src.size()).
+std::size_t lz4_compress(std::span<const u8> src, std::span<u8> dst) noexcept;
+
+// dst must be exactly the uncompressed size. Returns false on malformed input without reading or writing out of
+// bounds.
+bool lz4_decompress(std::span<const u8> src, std::span<u8> dst) noexcept;
+
+} // namespace Surreal
@@ -0,0 +1,755 @@
+#pragma once
+
+#include "base.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+// SSE2 is part of the x86-64 baseline; AVX and FMA are used when the compiler targets them (SURREAL_ENABLE_AVX2).
+// Define SURREAL_SIMD_DISABLE to force the scalar paths.
+#ifndef SURREAL_SIMD_DISABLE
+    #if defined(__AVX__)
+        #define SURREAL_SIMD_AVX 1
+    #endif
+    #if defined(__FMA__)
+        #define SURREAL_SIMD_FMA 1
+    #endif
+    #if defined(__SSE2__) || defined(_M_X64)
+        #define SURREAL_SIMD_SSE 1
+    #endif
+#endif
+
+#if SURREAL_SIMD_SSE || SURREAL_SIMD_AVX
+    #include <immintrin.h>
+#endif
+
+namespace Surreal
+{
+
+struct Vec2
+{
+    f32 x, y;
+
+    constexpr Vec2& operator+=(Vec2 rhs) noexcept { return x += rhs.x, y += rhs.y, *this; }
+    constexpr Vec2& operator-=(Vec2 rhs) noexcept { return x -= rhs.x, y -= rhs.y, *this; }
+    constexpr Vec2& operator*=(f32 s) noexcept { return x *= s, y *= s, *this; }
+
+    constexpr bool operator==(const Vec2&) const noexcept = default;
+};
+
+constexpr Vec2 operator+(Vec2 a, Vec2 b) noexcept { return { a.x + b.x, a.y + b.y }; }
+constexpr Vec2 operator-(Vec2 a, Vec2 b) noexcept { return { a.x - b.x, a.y - b.y }; }
+constexpr Vec2 operator-(Vec2 a) noexcept { return { -a.x, -a.y }; }
+constexpr Vec2 operator*(Vec2 a, Vec2 b) noexcept { return { a.x * b.x, a.y * b.y }; }
+constexpr Vec2 operator*(Vec2 a, f32 s) noexcept { return { a.x * s, a.y * s }; }
+constexpr Vec2 operator*(f32 s, Vec2 a) noexcept { return a * s; }
+constexpr f32 dot(Vec2 a, Vec2 b) noexcept { return a.x * b.x + a.y * b.y; }
+
+struct Vec3
+{
+    f32 x, y, z;
+
+    constexpr Vec3& operator+=(const Vec3& rhs) noexcept { return x += rhs.x, y += rhs.y, z += rhs.z, *this; }
+    constexpr Vec3& operator-=(const Vec3& rhs) noexcept { return x -= rhs.x, y -= rhs.y, z -= rhs.z, *this; }
+    constexpr Vec3& operator*=(f32 s) noexcept { return x *= s, y *= s, z *= s, *this; }
+
+    constexpr bool operator==(const Vec3&) const noexcept = default;
+};
+
+constexpr Vec3 operator+(const Vec3& a, const Vec3& b) noexcept { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+constexpr Vec3 operator-(const Vec3& a, const Vec3& b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+constexpr Vec3 operator-(const Vec3& a) noexcept { return { -a.x, -a.y, -a.z }; }
+constexpr Vec3 operator*(const Vec3& a, const Vec3& b) noexcept { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+constexpr Vec3 operator*(const Vec3& a, f32 s) noexcept { return { a.x * s, a.y * s, a.z * s }; }
+constexpr Vec3 operator*(f32 s, const Vec3& a) noexcept { return a * s; }
+
+constexpr f32 dot(const Vec3& a, const Vec3& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+constexpr Vec3 cross(const Vec3& a, const Vec3& b) noexcept
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+constexpr Vec3 min(const Vec3& a, const Vec3& b) noexcept
+{
+    return { a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z };
+}
+
+constexpr Vec3 max(const Vec3& a, const Vec3& b) noexcept
+{
+    return { a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z };
+}
+
+inline f32 length(const Vec3& v) noexcept { return std::sqrt(dot(v, v)); }
+inline Vec3 normalize(const Vec3& v) noexcept { return v * (1.0f / length(v)); }
+
+struct alignas(16) Vec4
+{
+    f32 x, y, z, w;
+
+    constexpr f32 operator[](std::size_t i) const noexcept { return i == 0u ? x : i == 1u ? y : i == 2u ? z : w; }
+    constexpr Vec3 xyz() const noexcept { return { x, y, z }; }
+
+    constexpr bool operator==(const Vec4&) const noexcept = default;
+};
+
+namespace Detail
+{
+
+#if SURREAL_SIMD_SSE
+SURREAL_ALWAYS_INLINE __m128 load(const Vec4& v) noexcept { return _mm_load_ps(&v.x); }
+
+SURREAL_ALWAYS_INLINE Vec4 store(__m128 v) noexcept
+{
+    Vec4 r;
+    _mm_store_ps(&r.x, v);
+    return r;
+}
+#endif
+
+} // namespace Detail
+
+constexpr Vec4 operator+(const Vec4& a, const Vec4& b) noexcept
+{
+    return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+}
+
+constexpr Vec4 operator-(const Vec4& a, const Vec4& b) noexcept
+{
+    return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+}
+
+constexpr Vec4 operator*(const Vec4& a, f32 s) noexcept { return { a.x * s, a.y * s, a.z * s, a.w * s }; }
+constexpr Vec4 operator*(f32 s, const Vec4& a) noexcept { return a * s; }
+
+constexpr f32 dot(const Vec4& a, const Vec4& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// Rotation as a unit quaternion; (x, y, z) is the vector part.
+struct alignas(16) Quat
+{
+    f32 x, y, z, w;
+
+    static constexpr Quat identity() noexcept { return { 0.0f, 0.0f, 0.0f, 1.0f }; }
+
+    // axis must be normalized.
+    static Quat from_axis_angle(const Vec3& axis, f32 radians) noexcept
+    {
+        const f32 s{ std::sin(radians * 0.5f) };
+        return { axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f) };
+    }
+
+    constexpr bool operator==(const Quat&) const noexcept = default;
+};
+
+// a * b applies b first.
+constexpr Quat operator*(const Quat& a, const Quat& b) noexcept
+{
+    return { a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z };
+}
+
+constexpr Quat conjugate(const Quat& q) noexcept { return { -q.x, -q.y, -q.z, q.w }; }
+constexpr f32 dot(const Quat& a, const Quat& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline Quat normalize(const Quat& q) noexcept
+{
+    const f32 s{ 1.0f / std::sqrt(dot(q, q)) };
+    return { q.x * s, q.y * s, q.z * s, q.w * s };
+}
+
+constexpr Vec3 rotate(const Quat& q, const Vec3& v) noexcept
+{
+    const Vec3 u{ q.x, q.y, q.z };
+    const Vec3 t{ cross(u, v) * 2.0f };
+    return v + t * q.w + cross(u, t);
+}
+
+// Normalized linear interpolation along the shorter arc. Cheaper than slerp and close enough for small steps.
+inline Quat nlerp(const Quat& a, const Quat& b, f32 t) noexcept
+{
+    const f32 sign{ dot(a, b) < 0.0f ? -1.0f : 1.0f };
+    const f32 u{ 1.0f - t };
+    const f32 v{ t * sign };
+    return normalize(Quat{ a.x * u + b.x * v, a.y * u + b.y * v, a.z * u + b.z * v, a.w * u + b.w * v });
+}
+
+inline Quat slerp(const Quat& a, const Quat& b, f32 t) noexcept
+{
+    f32 cos_theta{ dot(a, b) };
+    const f32 sign{ cos_theta < 0.0f ? -1.0f : 1.0f };
+    cos_theta *= sign;
+
+    if (cos_theta > 0.9995f)
+        return nlerp(a, b, t);
+
+    const f32 theta{ std::acos(cos_theta) };
+    const f32 inv_sin{ 1.0f / std::sin(theta) };
+    const f32 u{ std::sin((1.0f - t) * theta) * inv_sin };
+    const f32 v{ std::sin(t * theta) * inv_sin * sign };
+    return { a.x * u + b.x * v, a.y * u + b.y * v, a.z * u + b.z * v, a.w * u + b.w * v };
+}
+
+// Column-major, for column vectors: transforms compose right to left, and cols[3] holds the translation.
+// Projections are right-handed with clip-space depth in [0, 1].
+struct alignas(16) Mat4
+{
+    Vec4 cols[4];
+
+    static constexpr Mat4 identity() noexcept
+    {
+        return { { { 1.0f, 0.0f, 0.0f, 0.0f },
+                   { 0.0f, 1.0f, 0.0f, 0.0f },
+                   { 0.0f, 0.0f, 1.0f, 0.0f },
+                   { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    }
+
+    static constexpr Mat4 translate(const Vec3& t) noexcept
+    {
+        Mat4 m{ identity() };
+        m.cols[3] = { t.x, t.y, t.z, 1.0f };
+        return m;
+    }
+
+    static constexpr Mat4 scale(const Vec3& s) noexcept
+    {
+        return { { { s.x, 0.0f, 0.0f, 0.0f }, { 0.0f, s.y, 0.0f, 0.0f }, { 0.0f, 0.0f, s.z, 0.0f },
+                   { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    }
+
+    static constexpr Mat4 rotate(const Quat& q) noexcept
+    {
+        const f32 xx{ q.x * q.x }, yy{ q.y * q.y }, zz{ q.z * q.z };
+        const f32 xy{ q.x * q.y }, xz{ q.x * q.z }, yz{ q.y * q.z };
+        const f32 wx{ q.w * q.x }, wy{ q.w * q.y }, wz{ q.w * q.z };
+
+        return { { { 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f },
+                   { 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f },
+                   { 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f },
+                   { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    }
+
+    // Scale, then rotate, then translate.
+    static constexpr Mat4 trs(const Vec3& t, const Quat& r, const Vec3& s) noexcept
+    {
+        Mat4 m{ rotate(r) };
+        m.cols[0] = m.cols[0] * s.x;
+        m.cols[1] = m.cols[1] * s.y;
+        m.cols[2] = m.cols[2] * s.z;
+        m.cols[3] = { t.x, t.y, t.z, 1.0f };
+        return m;
+    }
+
+    static Mat4 perspective(f32 fov_y, f32 aspect, f32 z_near, f32 z_far) noexcept
+    {
+        const f32 f{ 1.0f / std::tan(fov_y * 0.5f) };
+        const f32 range{ z_far / (z_near - z_far) };
+        return { { { f / aspect, 0.0f, 0.0f, 0.0f },
+                   { 0.0f, f, 0.0f, 0.0f },
+                   { 0.0f, 0.0f, range, -1.0f },
+                   { 0.0f, 0.0f, range * z_near, 0.0f } } };
+    }
+
+    static constexpr Mat4 orthographic(f32 left, f32 right, f32 bottom, f32 top, f32 z_near, f32 z_far) noexcept
+    {
+        return { { { 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
+                   { 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f },
+                   { 0.0f, 0.0f, 1.0f / (z_near - z_far), 0.0f },
+                   { (left + right) / (left - right), (bottom + top) / (bottom - top), z_near / (z_near - z_far),
+                     1.0f } } };
+    }
+
+    static Mat4 look_at(const Vec3& eye, const Vec3& target, const Vec3& up) noexcept
+    {
+        const Vec3 f{ normalize(target - eye) };
+        const Vec3 s{ normalize(cross(f, up)) };
+        const Vec3 u{ cross(s, f) };
+        return { { { s.x, u.x, -f.x, 0.0f },
+                   { s.y, u.y, -f.y, 0.0f },
+                   { s.z, u.z, -f.z, 0.0f },
+                   { -dot(s, eye), -dot(u, eye), dot(f, eye), 1.0f } } };
+    }
+
+    constexpr Vec4 row(std::size_t i) const noexcept { return { cols[0][i], cols[1][i], cols[2][i], cols[3][i] }; }
+
+    constexpr bool operator==(const Mat4&) const noexcept = default;
+};
+
+constexpr Vec4 operator*(const Mat4& m, const Vec4& v) noexcept
+{
+#if SURREAL_SIMD_SSE
+    if (!std::is_constant_evaluated())
+    {
+        __m128 r{ _mm_mul_ps(Detail::load(m.cols[0]), _mm_set1_ps(v.x)) };
+        r = _mm_add_ps(r, _mm_mul_ps(Detail::load(m.cols[1]), _mm_set1_ps(v.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(Detail::load(m.cols[2]), _mm_set1_ps(v.z)));
+        r = _mm_add_ps(r, _mm_mul_ps(Detail::load(m.cols[3]), _mm_set1_ps(v.w)));
+        return Detail::store(r);
+    }
+#endif
+    return m.cols[0] * v.x + m.cols[1] * v.y + m.cols[2] * v.z + m.cols[3] * v.w;
+}
+
+constexpr Mat4 operator*(const Mat4& a, const Mat4& b) noexcept
+{
+    return { { a * b.cols[0], a * b.cols[1], a * b.cols[2], a * b.cols[3] } };
+}
+
+constexpr Vec3 transform_point(const Mat4& m, const Vec3& p) noexcept
+{
+    return (m * Vec4{ p.x, p.y, p.z, 1.0f }).xyz();
+}
+
+constexpr Vec3 transform_vector(const Mat4& m, const Vec3& v) noexcept
+{
+    return (m * Vec4{ v.x, v.y, v.z, 0.0f }).xyz();
+}
+
+constexpr Mat4 transpose(const Mat4& m) noexcept { return { { m.row(0), m.row(1), m.row(2), m.row(3) } }; }
+
+// General inverse by cofactors. Returns the zero matrix if m is singular.
+constexpr Mat4 inverse(const Mat4& m) noexcept
+{
+    const Vec4 &c0{ m.cols[0] }, &c1{ m.cols[1] }, &c2{ m.cols[2] }, &c3{ m.cols[3] };
+
+    const f32 s0{ c0.x * c1.y - c1.x * c0.y }, s1{ c0.x * c1.z - c1.x * c0.z }, s2{ c0.x * c1.w - c1.x * c0.w };
+    const f32 s3{ c0.y * c1.z - c1.y * c0.z }, s4{ c0.y * c1.w - c1.y * c0.w }, s5{ c0.z * c1.w - c1.z * c0.w };
+    const f32 t0{ c2.x * c3.y - c3.x * c2.y }, t1{ c2.x * c3.z - c3.x * c2.z }, t2{ c2.x * c3.w - c3.x * c2.w };
+    const f32 t3{ c2.y * c3.z - c3.y * c2.z }, t4{ c2.y * c3.w - c3.y * c2.w }, t5{ c2.z * c3.w - c3.z * c2.w };
+
+    const f32 det{ s0 * t5 - s1 * t4 + s2 * t3 + s3 * t2 - s4 * t1 + s5 * t0 };
+    if (det == 0.0f)
+        return {};
+
+    const f32 inv{ 1.0f / det };
+    return { { { (c1.y * t5 - c1.z * t4 + c1.w * t3) * inv, (-c0.y * t5 + c0.z * t4 - c0.w * t3) * inv,
+                 (c3.y * s5 - c3.z * s4 + c3.w * s3) * inv, (-c2.y * s5 + c2.z * s4 - c2.w * s3) * inv },
+               { (-c1.x * t5 + c1.z * t2 - c1.w * t1) * inv, (c0.x * t5 - c0.z * t2 + c0.w * t1) * inv,
+                 (-c3.x * s5 + c3.z * s2 - c3.w * s1) * inv, (c2.x * s5 - c2.z * s2 + c2.w * s1) * inv },
+               { (c1.x * t4 - c1.y * t2 + c1.w * t0) * inv, (-c0.x * t4 + c0.y * t2 - c0.w * t0) * inv,
+                 (c3.x * s4 - c3.y * s2 + c3.w * s0) * inv, (-c2.x * s4 + c2.y * s2 - c2.w * s0) * inv },
+               { (-c1.x * t3 + c1.y * t1 - c1.z * t0) * inv, (c0.x * t3 - c0.y * t1 + c0.z * t0) * inv,
+                 (-c3.x * s3 + c3.y * s1 - c3.z * s0) * inv, (c2.x * s3 - c2.y * s1 + c2.z * s0) * inv } } };
+}
+
+struct AABB
+{
+    Vec3 min, max;
+
+    constexpr Vec3 get_center() const noexcept { return (min + max) * 0.5f; }
+    constexpr Vec3 get_extents() const noexcept { return (max - min) * 0.5f; }
+
+    constexpr bool contains(const Vec3& p) const noexcept
+    {
+        return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z;
+    }
+
+    constexpr bool intersects(const AABB& other) const noexcept
+    {
+        return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    constexpr bool operator==(const AABB&) const noexcept = default;
+};
+
+constexpr AABB merge(const AABB& a, const AABB& b) noexcept { return { min(a.min, b.min), max(a.max, b.max) }; }
+
+// Bounds of the transformed box, from the transformed center and the absolute rotation-scale applied to the extents.
+constexpr AABB transform(const Mat4& m, const AABB& box) noexcept
+{
+    const Vec3 c{ transform_point(m, box.get_center()) };
+    const Vec3 e{ box.get_extents() };
+    const auto abs{ [](f32 v) { return v < 0.0f ? -v : v; } };
+    const Vec3 r{ abs(m.cols[0].x) * e.x + abs(m.cols[1].x) * e.y + abs(m.cols[2].x) * e.z,
+                  abs(m.cols[0].y) * e.x + abs(m.cols[1].y) * e.y + abs(m.cols[2].y) * e.z,
+                  abs(m.cols[0].z) * e.x + abs(m.cols[1].z) * e.y + abs(m.cols[2].z) * e.z };
+    return { c - r, c + r };
+}
+
+// Planes as (normal, distance) with normals pointing inward, so a point p is inside when dot(n, p) + d >= 0.
+struct Frustum
+{
+    Vec4 planes[6];
+
+    // Planes of a view-projection matrix with clip-space depth in [0, 1], normalized so sphere radii compare
+    // against true distances.
+    static Frustum from_matrix(const Mat4& view_proj) noexcept
+    {
+        const Vec4 r0{ view_proj.row(0) }, r1{ view_proj.row(1) }, r2{ view_proj.row(2) }, r3{ view_proj.row(3) };
+        Frustum frustum{ { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2 } };
+        for (Vec4& p : frustum.planes)
+            p = p * (1.0f / length(p.xyz()));
+        return frustum;
+    }
+
+    constexpr bool test(const Vec3& center, f32 radius) const noexcept
+    {
+        for (const Vec4& p : planes)
+            if (dot(p.xyz(), center) + p.w < -radius)
+                return false;
+        return true;
+    }
+
+    constexpr bool test(const AABB& box) const noexcept
+    {
+        const Vec3 c{ box.get_center() };
+        const Vec3 e{ box.get_extents() };
+        for (const Vec4& p : planes)
+        {
+            const f32 r{ (p.x < 0.0f ? -p.x : p.x) * e.x + (p.y < 0.0f ? -p.y : p.y) * e.y +
+                         (p.z < 0.0f ? -p.z : p.z) * e.z };
+            if (dot(p.xyz(), c) + p.w < -r)
+                return false;
+        }
+        return true;
+    }
+};
+
+// Eight floats processed together: one AVX register, two SSE registers or a plain array, all with the same
+// 32-byte layout so data written by one build can be read by another.
+struct alignas(32) F32x8
+{
+#if SURREAL_SIMD_AVX
+    __m256 v;
+#elif SURREAL_SIMD_SSE
+    __m128 lo, hi;
+#else
+    f32 lanes[8];
+#endif
+
+    static F32x8 broadcast(f32 s) noexcept;
+    // p must be 32-byte aligned.
+    static F32x8 load(const f32* p) noexcept;
+    static F32x8 load_unaligned(const f32* p) noexcept;
+    void store(f32* p) const noexcept;
+};
+
+static_assert(sizeof(F32x8) == 32u);
+
+#if SURREAL_SIMD_AVX
+
+SURREAL_ALWAYS_INLINE F32x8 F32x8::broadcast(f32 s) noexcept { return { _mm256_set1_ps(s) }; }
+SURREAL_ALWAYS_INLINE F32x8 F32x8::load(const f32* p) noexcept { return { _mm256_load_ps(p) }; }
+SURREAL_ALWAYS_INLINE F32x8 F32x8::load_unaligned(const f32* p) noexcept { return { _mm256_loadu_ps(p) }; }
+SURREAL_ALWAYS_INLINE void F32x8::store(f32* p) const noexcept { _mm256_store_ps(p, v); }
+
+SURREAL_ALWAYS_INLINE F32x8 operator+(const F32x8& a, const F32x8& b) noexcept { return { _mm256_add_ps(a.v, b.v) }; }
+SURREAL_ALWAYS_INLINE F32x8 operator-(const F32x8& a, const F32x8& b) noexcept { return { _mm256_sub_ps(a.v, b.v) }; }
+SURREAL_ALWAYS_INLINE F32x8 operator*(const F32x8& a, const F32x8& b) noexcept { return { _mm256_mul_ps(a.v, b.v) }; }
+SURREAL_ALWAYS_INLINE F32x8 operator/(const F32x8& a, const F32x8& b) noexcept { return { _mm256_div_ps(a.v, b.v) }; }
+SURREAL_ALWAYS_INLINE F32x8 min(const F32x8& a, const F32x8& b) noexcept { return { _mm256_min_ps(a.v, b.v) }; }
+SURREAL_ALWAYS_INLINE F32x8 max(const F32x8& a, const F32x8& b) noexcept { return { _mm256_max_ps(a.v, b.v) }; }
+
+// a * b + c
+SURREAL_ALWAYS_INLINE F32x8 fmadd(const F32x8& a, const F32x8& b, const F32x8& c) noexcept
+{
+    #if SURREAL_SIMD_FMA
+    return { _mm256_fmadd_ps(a.v, b.v, c.v) };
+    #else
+    return { _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v) };
+    #endif
+}
+
+// Comparisons return lane masks (all bits set or clear) for use with select(), &, | and movemask().
+SURREAL_ALWAYS_INLINE F32x8 operator<(const F32x8& a, const F32x8& b) noexcept
+{
+    return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) };
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator>=(const F32x8& a, const F32x8& b) noexcept
+{
+    return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) };
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator&(const F32x8& a, const F32x8& b) noexcept { return { _mm256_and_ps(a.v, b.v) }; }
+SURREAL_ALWAYS_INLINE F32x8 operator|(const F32x8& a, const F32x8& b) noexcept { return { _mm256_or_ps(a.v, b.v) }; }
+
+SURREAL_ALWAYS_INLINE F32x8 select(const F32x8& mask, const F32x8& a, const F32x8& b) noexcept
+{
+    return { _mm256_blendv_ps(b.v, a.v, mask.v) };
+}
+// Bit i is set when lane i of mask is set.
+SURREAL_ALWAYS_INLINE u32 movemask(const F32x8& mask) noexcept { return static_cast<u32>(_mm256_movemask_ps(mask.v)); }
+
+#elif SURREAL_SIMD_SSE
+
+SURREAL_ALWAYS_INLINE F32x8 F32x8::broadcast(f32 s) noexcept { return { _mm_set1_ps(s), _mm_set1_ps(s) }; }
+SURREAL_ALWAYS_INLINE F32x8 F32x8::load(const f32* p) noexcept { return { _mm_load_ps(p), _mm_load_ps(p + 4) }; }
+
+SURREAL_ALWAYS_INLINE F32x8 F32x8::load_unaligned(const f32* p) noexcept
+{
+    return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) };
+}
+
+SURREAL_ALWAYS_INLINE void F32x8::store(f32* p) const noexcept
+{
+    _mm_store_ps(p, lo);
+    _mm_store_ps(p + 4, hi);
+}
+
+    #define SURREAL_F32X8_BINARY(op, intrinsic)                                                                        \
+        SURREAL_ALWAYS_INLINE F32x8 op(const F32x8& a, const F32x8& b) noexcept                                        \
+        {                                                                                                              \
+            return { intrinsic(a.lo, b.lo), intrinsic(a.hi, b.hi) };                                                   \
+        }
+
+SURREAL_F32X8_BINARY(operator+, _mm_add_ps)
+SURREAL_F32X8_BINARY(operator-, _mm_sub_ps)
+SURREAL_F32X8_BINARY(operator*, _mm_mul_ps)
+SURREAL_F32X8_BINARY(operator/, _mm_div_ps)
+SURREAL_F32X8_BINARY(min, _mm_min_ps)
+SURREAL_F32X8_BINARY(max, _mm_max_ps)
+SURREAL_F32X8_BINARY(operator<, _mm_cmplt_ps)
+SURREAL_F32X8_BINARY(operator>=, _mm_cmpge_ps)
+SURREAL_F32X8_BINARY(operator&, _mm_and_ps)
+SURREAL_F32X8_BINARY(operator|, _mm_or_ps)
+
+    #undef SURREAL_F32X8_BINARY
+
+SURREAL_ALWAYS_INLINE F32x8 fmadd(const F32x8& a, const F32x8& b, const F32x8& c) noexcept { return a * b + c; }
+
+SURREAL_ALWAYS_INLINE F32x8 select(const F32x8& mask, const F32x8& a, const F32x8& b) noexcept
+{
+    return { _mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo)),
+             _mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi)) };
+}
+
+SURREAL_ALWAYS_INLINE u32 movemask(const F32x8& mask) noexcept
+{
+    return static_cast<u32>(_mm_movemask_ps(mask.lo) | (_mm_movemask_ps(mask.hi) << 4));
+}
+
+#else
+
+SURREAL_ALWAYS_INLINE F32x8 F32x8::broadcast(f32 s) noexcept { return { { s, s, s, s, s, s, s, s } }; }
+
+SURREAL_ALWAYS_INLINE F32x8 F32x8::load(const f32* p) noexcept { return load_unaligned(p); }
+
+SURREAL_ALWAYS_INLINE F32x8 F32x8::load_unaligned(const f32* p) noexcept
+{
+    F32x8 r;
+    for (std::size_t i{ 0u }; i < 8u; ++i)
+        r.lanes[i] = p[i];
+    return r;
+}
+
+SURREAL_ALWAYS_INLINE void F32x8::store(f32* p) const noexcept
+{
+    for (std::size_t i{ 0u }; i < 8u; ++i)
+        p[i] = lanes[i];
+}
+
+namespace Detail
+{
+
+constexpr f32 s_lane_true{ std::bit_cast<f32>(~0u) };
+
+template <typename OpTp>
+SURREAL_ALWAYS_INLINE F32x8 lanewise(const F32x8& a, const F32x8& b, OpTp op) noexcept
+{
+    F32x8 r;
+    for (std::size_t i{ 0u }; i < 8u; ++i)
+        r.lanes[i] = op(a.lanes[i], b.lanes[i]);
+    return r;
+}
+
+SURREAL_ALWAYS_INLINE u32 bits(f32 v) noexcept { return std::bit_cast<u32>(v); }
+
+} // namespace Detail
+
+SURREAL_ALWAYS_INLINE F32x8 operator+(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x + y; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator-(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x - y; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator*(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x * y; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator/(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x / y; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 min(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x < y ? x : y; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 max(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x > y ? x : y; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 fmadd(const F32x8& a, const F32x8& b, const F32x8& c) noexcept { return a * b + c; }
+
+SURREAL_ALWAYS_INLINE F32x8 operator<(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x < y ? Detail::s_lane_true : 0.0f; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator>=(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return x >= y ? Detail::s_lane_true : 0.0f; });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator&(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return std::bit_cast<f32>(Detail::bits(x) & Detail::bits(y)); });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 operator|(const F32x8& a, const F32x8& b) noexcept
+{
+    return Detail::lanewise(a, b, [](f32 x, f32 y) { return std::bit_cast<f32>(Detail::bits(x) | Detail::bits(y)); });
+}
+
+SURREAL_ALWAYS_INLINE F32x8 select(const F32x8& mask, const F32x8& a, const F32x8& b) noexcept
+{
+    F32x8 r;
+    for (std::size_t i{ 0u }; i < 8u; ++i)
+        r.lanes[i] = Detail::bits(mask.lanes[i]) ? a.lanes[i] : b.lanes[i];
+    return r;
+}
+
+SURREAL_ALWAYS_INLINE u32 movemask(const F32x8& mask) noexcept
+{
+    u32 r{ 0u };
+    for (u32 i{ 0u }; i < 8u; ++i)
+        r |= (Detail::bits(mask.lanes[i]) >> 31u) << i;
+    return r;
+}
+
+#endif
+
+// Eight Vec3 in SoA form. Arrays of these (AoSoA) keep every lane load contiguous; use load()/store() to convert from
+// and to plain Vec3 arrays such as ECS component columns.
+struct Vec3x8
+{
+    F32x8 x, y, z;
+
+    static SURREAL_ALWAYS_INLINE Vec3x8 broadcast(const Vec3& v) noexcept
+    {
+        return { F32x8::broadcast(v.x), F32x8::broadcast(v.y), F32x8::broadcast(v.z) };
+    }
+
+    // Gathers eight consecutive Vec3.
+    static SURREAL_ALWAYS_INLINE Vec3x8 load(const Vec3* p) noexcept
+    {
+        alignas(32) f32 xs[8], ys[8], zs[8];
+        for (std::size_t i{ 0u }; i < 8u; ++i)
+        {
+            xs[i] = p[i].x;
+            ys[i] = p[i].y;
+            zs[i] = p[i].z;
+        }
+        return { F32x8::load(xs), F32x8::load(ys), F32x8::load(zs) };
+    }
+
+    SURREAL_ALWAYS_INLINE void store(Vec3* p) const noexcept
+    {
+        alignas(32) f32 xs[8], ys[8], zs[8];
+        x.store(xs);
+        y.store(ys);
+        z.store(zs);
+        for (std::size_t i{ 0u }; i < 8u; ++i)
+            p[i] = { xs[i], ys[i], zs[i] };
+    }
+};
+
+SURREAL_ALWAYS_INLINE Vec3x8 operator+(const Vec3x8& a, const Vec3x8& b) noexcept
+{
+    return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+SURREAL_ALWAYS_INLINE Vec3x8 operator-(const Vec3x8& a, const Vec3x8& b) noexcept
+{
+    return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+SURREAL_ALWAYS_INLINE Vec3x8 operator*(const Vec3x8& a, const F32x8& s) noexcept
+{
+    return { a.x * s, a.y * s, a.z * s };
+}
+
+SURREAL_ALWAYS_INLINE F32x8 dot(const Vec3x8& a, const Vec3x8& b) noexcept
+{
+    return fmadd(a.x, b.x, fmadd(a.y, b.y, a.z * b.z));
+}
+
+SURREAL_ALWAYS_INLINE Vec3x8 min(const Vec3x8& a, const Vec3x8& b) noexcept
+{
+    return { min(a.x, b.x), min(a.y, b.y), min(a.z, b.z) };
+}
+
+SURREAL_ALWAYS_INLINE Vec3x8 max(const Vec3x8& a, const Vec3x8& b) noexcept
+{
+    return { max(a.x, b.x), max(a.y, b.y), max(a.z, b.z) };
+}
+
+// Affine transform of eight points; the projective row of m is ignored.
+SURREAL_ALWAYS_INLINE Vec3x8 transform_point(const Mat4& m, const Vec3x8& p) noexcept
+{
+    const auto lane{ [](f32 s) { return F32x8::broadcast(s); } };
+    const auto& c{ m.cols };
+    return { fmadd(lane(c[0].x), p.x, fmadd(lane(c[1].x), p.y, fmadd(lane(c[2].x), p.z, lane(c[3].x)))),
+             fmadd(lane(c[0].y), p.x, fmadd(lane(c[1].y), p.y, fmadd(lane(c[2].y), p.z, lane(c[3].y)))),
+             fmadd(lane(c[0].z), p.x, fmadd(lane(c[1].z), p.y, fmadd(lane(c[2].z), p.z, lane(c[3].z)))) };
+}
+
+// Eight boxes as center and half-extents, the form frustum tests want.
+struct AABBx8
+{
+    Vec3x8 center, extents;
+};
+
+struct Spherex8
+{
+    Vec3x8 center;
+    F32x8 radius;
+};
+
+// Bit i of the result is set when box or sphere i is at least partially inside the frustum.
+SURREAL_ALWAYS_INLINE u32 test(const Frustum& frustum, const AABBx8& boxes) noexcept
+{
+    F32x8 inside{ F32x8::broadcast(std::bit_cast<f32>(~0u)) };
+    for (const Vec4& p : frustum.planes)
+    {
+        const Vec3x8 n{ Vec3x8::broadcast(p.xyz()) };
+        const Vec3x8 abs_n{ Vec3x8::broadcast({ std::abs(p.x), std::abs(p.y), std::abs(p.z) }) };
+        const F32x8 distance{ dot(n, boxes.center) + F32x8::broadcast(p.w) };
+        inside = inside & (distance + dot(abs_n, boxes.extents) >= F32x8::broadcast(0.0f));
+    }
+    return movemask(inside);
+}
+
+SURREAL_ALWAYS_INLINE u32 test(const Frustum& frustum, const Spherex8& spheres) noexcept
+{
+    F32x8 inside{ F32x8::broadcast(std::bit_cast<f32>(~0u)) };
+    for (const Vec4& p : frustum.planes)
+    {
+        const F32x8 distance{ dot(Vec3x8::broadcast(p.xyz()), spheres.center) + F32x8::broadcast(p.w) };
+        inside = inside & (distance + spheres.radius >= F32x8::broadcast(0.0f));
+    }
+    return movemask(inside);
+}
+
+// Batch versions over AoSoA arrays. out may alias points.
+void transform_points(const Mat4& m, std::span<const Vec3x8> points, std::span<Vec3x8> out) noexcept;
+
+// Writes one visibility bitmask per block of eight to visible and returns the number of visible objects. count is
+// the number of objects; lanes past it, and whole blocks past it, are ignored.
+std::size_t cull(const Frustum& frustum, std::span<const AABBx8> boxes, std::size_t count,
+                 std::span<u8> visible) noexcept;
+std::size_t cull(const Frustum& frustum, std::span<const Spherex8> spheres, std::size_t count,
+                 std::span<u8> visible) noexcept;
+
+} // namespace Surreal
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "base.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <new>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Surreal
+{
+
+enum struct MemoryTag : u8
+{
+    Core,
+    Window,
+    Events,
+    App,
+    Assets,
+    Capture,
+    Count,
+};
+
+constexpr std::string_view to_string(MemoryTag tag) noexcept
+{
+    constexpr std::string_view names[]{ "core", "window", "events", "app", "assets", "capture" };
+    return names[static_cast<u8>(tag)];
+}
+
+struct MemoryStats
+{
+    // Signed because a thread freeing memory another thread allocated sees its own share go negative.
+    i64 live_bytes;
+    i64 live_allocations;
+    u64 total_allocations;
+    // Highest live_bytes any merge has seen; merges happen in get_stats() and check_budgets().
+    i64 peak_bytes;
+    // Zero if the tag has no budget.
+    u64 budget;
+};
+
+struct PoolStats
+{
+    u64 reserved_bytes;
+    u64 slab_count;
+};
+
+// Tagged allocation front end. Every thread counts into its own block of counters, written without atomic
+// read-modify-writes, and the blocks are only summed when stats are asked for. Allocations of up to s_max_small_size
+// bytes come from size-class pools with a per-thread cache, so small node allocations are cheaper than going to
+// malloc even with the bookkeeping.
+class Memory
+{
+public:
+    Memory() = delete;
+
+    static constexpr std::size_t s_max_small_size{ 256u };
+    static constexpr std::size_t s_small_alignment{ 16u };
+
+    // Throws std::bad_alloc on failure.
+    static void* allocate(std::size_t size, std::size_t alignment, MemoryTag tag);
+    // size, alignment and tag must match the allocate() call.
+    static void deallocate(void* ptr, std::size_t size, std::size_t alignment, MemoryTag tag) noexcept;
+
+    static MemoryStats get_stats(MemoryTag tag) noexcept;
+    static PoolStats get_pool_stats() noexcept;
+
+    // Small allocations of the calling thread come from the pools of this NUMA node from now on, and new slabs are
+    // bound to it. AffinityPlan calls it for every thread it pins.
+    static void set_thread_node(u32 node) noexcept;
+
+    static void set_budget(MemoryTag tag, u64 bytes) noexcept;
+    // Warns once for each tag that has gone over its budget since the last call that saw it under. Returns the
+    // number of tags over budget. Application calls this every frame.
+    static u32 check_budgets() noexcept;
+
+    // Logs every tag with live allocations; returns true if there were none. Run at shutdown, after everything
+    // tracked should have been released.
+    static bool report_leaks() noexcept;
+};
+
+// Standard allocator that counts against a tag.
+template <typename Tp, MemoryTag Tag>
+class TaggedAllocator
+{
+public:
+    typedef Tp value_type;
+
+    template <typename Up>
+    struct rebind
+    {
+        typedef TaggedAllocator<Up, Tag> other;
+    };
+
+    constexpr TaggedAllocator() noexcept = default;
+    template <typename Up>
+    constexpr TaggedAllocator(const TaggedAllocator<Up, Tag>&) noexcept
+    {
+    }
+
+    Tp* allocate(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(Tp)) SURREAL_UNLIKELY
+            throw std::bad_array_new_length();
+        return static_cast<Tp*>(Memory::allocate(n * sizeof(Tp), alignof(Tp), Tag));
+    }
+
+    void deallocate(Tp* ptr, std::size_t n) noexcept { Memory::deallocate(ptr, n * sizeof(Tp), alignof(Tp), Tag); }
+
+    friend constexpr bool operator==(const TaggedAllocator&, const TaggedAllocator&) noexcept { return true; }
+};
+
+template <typename Tp, MemoryTag Tag>
+using TaggedVector = std::vector<Tp, TaggedAllocator<Tp, Tag>>;
+
+template <typename Key, typename Tp, MemoryTag Tag, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using TaggedUnorderedMap =
+    std::unordered_map<Key, Tp, Hash, KeyEqual, TaggedAllocator<std::pair<const Key, Tp>, Tag>>;
+
+} // namespace Surreal
+
+// Routes new and delete of a class, and of everything derived from it, through a memory tag. The sized delete sees
+// the dynamic size as long as the destructor is virtual.
+#define SURREAL_TAGGED_NEW(tag)                                                                                        \
+    static void* operator new(std::size_t size)                                                                        \
+    {                                                                                                                  \
+        return ::Surreal::Memory::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag);                               \
+    }                                                                                                                  \
+    static void* operator new(std::size_t size, std::align_val_t alignment)                                            \
+    {                                                                                                                  \
+        return ::Surreal::Memory::allocate(size, static_cast<std::size_t>(alignment), tag);                            \
+    }                                                                                                                  \
+    static void operator delete(void* ptr, std::size_t size) noexcept                                                  \
+    {                                                                                                                  \
+        ::Surreal::Memory::deallocate(ptr, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag);                               \
+    }                                                                                                                  \
+    static void operator delete(void* ptr, std::size_t size, std::align_val_t alignment) noexcept                      \
+    {                                                                                                                  \
+        ::Surreal::Memory::deallocate(ptr, size, static_cast<std::size_t>(alignment), tag);                            \
+    }
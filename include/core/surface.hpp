@@ -0,0 +1,84 @@
+#pragma once
+
+#include "base.hpp"
+
+#include <span>
+#include <vector>
+
+namespace Surreal
+{
+
+// 0xAARRGGBB, which is B, G, R, A in memory and matches a 24/32-bit X11 ZPixmap.
+typedef u32 Pixel;
+
+constexpr Pixel make_pixel(u8 r, u8 g, u8 b, u8 a = 0xffu) noexcept
+{
+    return static_cast<Pixel>(a) << 24u | static_cast<Pixel>(r) << 16u | static_cast<Pixel>(g) << 8u | b;
+}
+
+// CPU-side window contents. Anything that writes through the mutable accessors marks the surface dirty, and the
+// window only presents dirty surfaces, so a frame that draws nothing costs nothing to present. After swap_pixels()
+// the contents are stale until the next write, and the window does not present them in the meantime.
+class Surface
+{
+public:
+    Surface() : m_size(), m_pixels(), m_dirty(false), m_stale(false), m_revision(0u) {}
+
+    // Contents are cleared to black, which is also what the window shows in newly exposed areas, so this does not
+    // dirty the surface. Keeps the allocation when shrinking.
+    void resize(Size size);
+    void clear(Pixel color = make_pixel(0u, 0u, 0u));
+
+    constexpr Size get_size() const noexcept { return m_size; }
+
+    std::span<Pixel> get_pixels() noexcept
+    {
+        m_dirty = true;
+        m_stale = false;
+        ++m_revision;
+        return { m_pixels.data(), static_cast<std::size_t>(m_size.w) * m_size.h };
+    }
+    std::span<const Pixel> get_pixels() const noexcept
+    {
+        return { m_pixels.data(), static_cast<std::size_t>(m_size.w) * m_size.h };
+    }
+
+    Pixel* get_row(u32 y) noexcept
+    {
+        m_dirty = true;
+        m_stale = false;
+        ++m_revision;
+        return m_pixels.data() + static_cast<std::size_t>(y) * m_size.w;
+    }
+    const Pixel* get_row(u32 y) const noexcept { return m_pixels.data() + static_cast<std::size_t>(y) * m_size.w; }
+
+    constexpr bool is_dirty() const noexcept { return m_dirty; }
+    constexpr void mark_dirty() noexcept
+    {
+        m_dirty = true;
+        ++m_revision;
+    }
+    constexpr void mark_clean() noexcept { m_dirty = false; }
+
+    // Set while the surface holds pixels it was given by swap_pixels() rather than drawn ones. Whoever draws it has to
+    // redraw it in full; marking it dirty is not enough.
+    constexpr bool needs_redraw() const noexcept { return m_stale; }
+
+    // Bumped by every write access. Presenting does not reset it, so other readers of the surface can tell whether it
+    // changed since they last looked.
+    constexpr u64 get_revision() const noexcept { return m_revision; }
+
+    // Exchanges the pixel storage with pixels, which must hold exactly one pixel per surface pixel; returns false and
+    // leaves both alone otherwise. The surface is left holding whatever pixels held and needs_redraw() is set until the
+    // next write access. Neither the dirty flag nor the revision changes.
+    bool swap_pixels(std::vector<Pixel>& pixels) noexcept;
+
+private:
+    Size m_size;
+    std::vector<Pixel> m_pixels;
+    bool m_dirty;
+    bool m_stale;
+    u64 m_revision;
+};
+
+} // namespace Surreal
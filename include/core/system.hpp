@@ -0,0 +1,70 @@
+#pragma once
+
+#include "base.hpp"
+#include "ecs.hpp"
+#include "thread_pool.hpp"
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Surreal
+{
+
+// Runs systems over a World once per frame. Each system declares its components through its query type; systems
+// whose write sets do not overlap the other's read or write set run concurrently on the pool. Conflicting systems
+// keep their registration order. Structural changes go through the system's CommandBuffer and are applied, in
+// registration order, after every system has run.
+class SystemScheduler
+{
+public:
+    SystemScheduler(World& world, ThreadPool& pool);
+
+    SystemScheduler(const SystemScheduler&) = delete;
+    SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+    // func(Query<Ts...>&, CommandBuffer&, f32 delta_time)
+    template <typename... Ts, typename FuncTp>
+    void add_system(std::string name, FuncTp&& func)
+    {
+        auto system{ std::make_unique<System>() };
+        system->name = std::move(name);
+        system->reads = Query<Ts...>::get_reads();
+        system->writes = Query<Ts...>::get_writes();
+        system->run = [query = Query<Ts...>(m_world), func = std::forward<FuncTp>(func)](
+                          CommandBuffer& commands, f32 delta_time) mutable { func(query, commands, delta_time); };
+
+        m_systems.emplace_back(std::move(system));
+        m_stages_dirty = true;
+    }
+
+    void run(f32 delta_time);
+
+    // Indices of the systems in each stage, in execution order.
+    std::span<const std::vector<u32>> get_stages();
+    const std::string& get_system_name(u32 system) const { return m_systems[system]->name; }
+    u32 get_system_count() const noexcept { return static_cast<u32>(m_systems.size()); }
+
+private:
+    struct System
+    {
+        std::string name;
+        ComponentMask reads;
+        ComponentMask writes;
+        std::function<void(CommandBuffer&, f32)> run;
+        CommandBuffer commands;
+    };
+
+    void build_stages();
+
+    World& m_world;
+    ThreadPool& m_pool;
+
+    std::vector<std::unique_ptr<System>> m_systems;
+    std::vector<std::vector<u32>> m_stages;
+    bool m_stages_dirty;
+};
+
+} // namespace Surreal
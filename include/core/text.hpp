@@ -0,0 +1,251 @@
+#pragma once
+
+#include "base.hpp"
+#include "exception.hpp"
+#include "surface.hpp"
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+namespace Surreal
+{
+
+class FontError : public RuntimeError
+{
+public:
+    explicit FontError(const std::string& msg) : RuntimeError(msg) {}
+};
+
+struct GlyphBitmap
+{
+    u32 width, height;
+    // Offset of the top-left pixel from the pen position, y up, as FreeType reports it.
+    i32 left, top;
+    std::vector<u8> coverage;
+};
+
+// A font face at one pixel size. Codepoint lookups and advances are cached, so shaping a string only reaches FreeType
+// for glyphs it has not seen before. Not thread-safe.
+class Font
+{
+public:
+    // Throws FontError if the file cannot be loaded or does not contain a scalable face.
+    Font(const std::string& path, u32 pixel_size);
+    ~Font();
+
+    Font(const Font&) = delete;
+    Font& operator=(const Font&) = delete;
+
+    u32 get_glyph_index(char32_t codepoint);
+    f32 get_advance(u32 glyph);
+    f32 get_kerning(u32 left, u32 right) const noexcept;
+
+    // Renders an 8-bit coverage bitmap; returns false if FreeType cannot render the glyph.
+    bool rasterize(u32 glyph, GlyphBitmap& out) const;
+
+    // Unique per font for the lifetime of the process; atlas and run cache keys are built from it.
+    constexpr u32 get_id() const noexcept { return m_id; }
+    constexpr u32 get_pixel_size() const noexcept { return m_pixel_size; }
+    constexpr i32 get_ascender() const noexcept { return m_ascender; }
+    constexpr i32 get_line_height() const noexcept { return m_line_height; }
+
+private:
+    FT_LibraryRec_* m_library;
+    FT_FaceRec_* m_face;
+    u32 m_id;
+    u32 m_pixel_size;
+    i32 m_ascender;
+    i32 m_line_height;
+    bool m_has_kerning;
+
+    std::array<u32, 128> m_ascii_glyphs;
+    std::unordered_map<char32_t, u32> m_glyphs;
+    std::vector<f32> m_advances; // Negative until loaded.
+};
+
+struct AtlasGlyph
+{
+    u16 x, y, width, height;
+    i16 left, top;
+    u16 shelf;
+};
+
+struct AtlasStats
+{
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+    // Glyphs that did not fit even after evicting every shelf not used this frame.
+    u64 failures;
+    u32 glyph_count;
+    u32 shelf_count;
+
+    constexpr f32 get_hit_rate() const noexcept
+    {
+        return hits + misses ? static_cast<f32>(hits) / static_cast<f32>(hits + misses) : 1.0f;
+    }
+};
+
+// Single-channel glyph cache packed into shelves. Eviction is least-recently-used by shelf: a shelf remembers the last
+// frame any of its glyphs was used and is emptied as a whole, which keeps packing trivial and never evicts a glyph the
+// current frame has already handed out.
+class GlyphAtlas
+{
+public:
+    explicit GlyphAtlas(u32 size = 1024u);
+
+    void begin_frame() noexcept { ++m_frame; }
+
+    // Looks the glyph up, rasterizing it on a miss. nullptr if it cannot be rendered or does not fit.
+    const AtlasGlyph* get(Font& font, u32 glyph);
+
+    // Each eviction bumps the shelf's epoch, so anything holding atlas coordinates can tell whether they still hold.
+    constexpr u32 get_epoch(u16 shelf) const noexcept { return m_shelves[shelf].epoch; }
+    // Marks the shelf used this frame if it is still at epoch; returns false otherwise.
+    bool touch(u16 shelf, u32 epoch) noexcept;
+
+    constexpr u32 get_size() const noexcept { return m_size; }
+    std::span<const u8> get_pixels() const noexcept { return m_pixels; }
+
+    // Area written since the last clear_dirty(), for uploading to a texture.
+    constexpr Rect get_dirty_rect() const noexcept { return m_dirty; }
+    constexpr void clear_dirty() noexcept { m_dirty = {}; }
+
+    constexpr const AtlasStats& get_stats() const noexcept { return m_stats; }
+    void reset_stats() noexcept;
+
+private:
+    struct Shelf
+    {
+        u32 y;
+        u32 height;
+        u32 used_width;
+        u32 epoch;
+        u64 last_used;
+        std::vector<u64> keys;
+    };
+
+    static constexpr u64 make_key(u32 font_id, u32 glyph) noexcept
+    {
+        return static_cast<u64>(font_id) << 32u | glyph;
+    }
+
+    // Returns the shelf index the area was placed on, or -1.
+    i32 allocate(u32 width, u32 height, u32& x);
+    void evict(Shelf& shelf);
+    void mark_dirty(u32 x, u32 y, u32 width, u32 height) noexcept;
+
+    u32 m_size;
+    std::vector<u8> m_pixels;
+    std::vector<Shelf> m_shelves;
+    u32 m_next_shelf_y;
+    std::unordered_map<u64, AtlasGlyph> m_glyphs;
+    u64 m_frame;
+    Rect m_dirty;
+    AtlasStats m_stats;
+    GlyphBitmap m_scratch;
+};
+
+// A glyph rectangle on screen and its source rectangle in the atlas, both in pixels.
+struct GlyphQuad
+{
+    i32 x, y;
+    u16 width, height;
+    u16 u, v;
+    Pixel color;
+};
+
+struct TextBatch
+{
+    std::vector<GlyphQuad> quads;
+    // False when the frame drew exactly what the previous one did and the quads were kept as they were.
+    bool changed;
+};
+
+struct TextStats
+{
+    u64 run_hits;
+    u64 run_misses;
+    u64 batches_built;
+    u64 batches_reused;
+    u32 run_count;
+};
+
+// Immediate-mode text: draw() during the frame, end_frame() once to get every glyph of the frame as one batch.
+// Strings are shaped once and cached together with their quads, so redrawing text that did not change costs a hash
+// lookup per string, and a frame identical to the last one reuses the previous batch outright.
+class TextRenderer
+{
+public:
+    explicit TextRenderer(u32 atlas_size = 1024u);
+
+    void begin_frame();
+
+    // (x, y) is the top-left of the first line. Newlines start a new line at x.
+    void draw(Font& font, std::string_view text, i32 x, i32 y, Pixel color);
+    Size measure(Font& font, std::string_view text);
+
+    const TextBatch& end_frame();
+
+    // Alpha-blends the last batch into the surface.
+    void render(Surface& surface) const;
+
+    constexpr const GlyphAtlas& get_atlas() const noexcept { return m_atlas; }
+    constexpr const TextBatch& get_batch() const noexcept { return m_batch; }
+    constexpr const TextStats& get_stats() const noexcept { return m_stats; }
+
+private:
+    struct ShapedGlyph
+    {
+        u32 glyph;
+        // Pen position on the baseline, relative to the run origin.
+        i32 x, y;
+    };
+
+    struct TextRun
+    {
+        std::string text;
+        u32 font_id;
+        Size size;
+        std::vector<ShapedGlyph> glyphs;
+        // Relative to the run origin, colorless. Valid while every shelf they sample is at the recorded epoch.
+        std::vector<GlyphQuad> quads;
+        std::vector<std::pair<u16, u32>> shelves;
+        bool quads_valid;
+        u64 last_used;
+    };
+
+    struct DrawCommand
+    {
+        Font* font;
+        TextRun* run;
+        i32 x, y;
+        Pixel color;
+
+        constexpr bool operator==(const DrawCommand&) const noexcept = default;
+    };
+
+    TextRun& get_run(Font& font, std::string_view text);
+    void shape(Font& font, TextRun& run);
+    void build_quads(Font& font, TextRun& run);
+    bool touch(TextRun& run) noexcept;
+    void evict_runs();
+
+    GlyphAtlas m_atlas;
+    std::unordered_map<u64, TextRun> m_runs;
+    std::vector<DrawCommand> m_commands;
+    std::vector<DrawCommand> m_previous_commands;
+    TextBatch m_batch;
+    TextStats m_stats;
+    u64 m_frame;
+};
+
+} // namespace Surreal
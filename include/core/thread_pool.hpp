@@ -0,0 +1,96 @@
+#pragma once
+
+#include "base.hpp"
+#include "memory.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Surreal
+{
+
+// Fixed set of worker threads fed from a shared FIFO. Threads are started on first use, so owning a pool that is
+// never used costs nothing.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(u32 thread_count = get_default_thread_count());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // One less than the number of hardware threads, leaving one for the thread driving the frame.
+    static u32 get_default_thread_count() noexcept;
+
+    constexpr u32 get_thread_count() const noexcept { return m_thread_count; }
+
+    void submit(std::function<void()> task);
+
+    // Runs func(i) for every i in [0, count) on the workers and the calling thread, and returns once all calls have
+    // finished. The first exception thrown by func is rethrown here.
+    template <typename FuncTp>
+    void parallel_for(u32 count, FuncTp&& func)
+    {
+        if (!count)
+            return;
+
+        if (!m_thread_count || count == 1u)
+        {
+            for (u32 i{ 0u }; i < count; ++i)
+                func(i);
+            return;
+        }
+
+        auto state{ std::make_shared<ParallelForState>(count, [&func](u32 i) { func(i); }) };
+
+        const u32 helpers{ std::min(m_thread_count, count - 1u) };
+        for (u32 i{ 0u }; i < helpers; ++i)
+            submit([state] { state->work(); });
+
+        state->work();
+        state->wait();
+
+        if (state->error)
+            std::rethrow_exception(state->error);
+    }
+
+private:
+    struct ParallelForState
+    {
+        ParallelForState(u32 n, std::function<void(u32)> f) : count(n), func(std::move(f)) {}
+
+        void work() noexcept;
+        void wait();
+
+        const u32 count;
+        // Only dereferenced for claimed indices, so helpers starting after the caller returned never touch it.
+        std::function<void(u32)> func;
+        std::atomic<u32> next{ 0u };
+        std::atomic<u32> done{ 0u };
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+
+    void start();
+    void worker_loop();
+
+    u32 m_thread_count;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>, TaggedAllocator<std::function<void()>, MemoryTag::Core>> m_tasks;
+    bool m_started;
+    bool m_stopping;
+};
+
+} // namespace Surreal
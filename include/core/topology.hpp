@@ -0,0 +1,158 @@
+#pragma once
+
+#include "base.hpp"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Surreal
+{
+
+typedef std::vector<u32> CpuList;
+
+// Kernel cpulist syntax, e.g. "0-3,8,10-11". Malformed entries are skipped.
+CpuList parse_cpu_list(std::string_view text);
+std::string format_cpu_list(std::span<const u32> cpus);
+
+struct CpuCore
+{
+    u32 package;
+    u32 node;
+    // Logical CPUs of the core: more than one with SMT.
+    CpuList cpus;
+};
+
+struct CpuCache
+{
+    u32 level;
+    u64 size;
+    u32 line_size;
+    CpuList cpus;
+};
+
+struct NumaNode
+{
+    u32 id;
+    u64 memory;
+    CpuList cpus;
+};
+
+class CpuTopology
+{
+public:
+    static constexpr u32 s_invalid{ ~0u };
+
+    // Reads sysfs on Linux, keeping only the CPUs the process may run on. Falls back to one node with one core per
+    // allowed CPU when nothing can be read.
+    static CpuTopology detect(const std::string& sysfs_root = "/sys/devices/system");
+
+    constexpr std::span<const CpuCore> get_cores() const noexcept { return m_cores; }
+    constexpr std::span<const NumaNode> get_nodes() const noexcept { return m_nodes; }
+    // Data and unified caches only, one entry per cache instance.
+    constexpr std::span<const CpuCache> get_caches() const noexcept { return m_caches; }
+    // CPUs the kernel keeps the scheduler off (isolcpus); threads only run there when pinned.
+    constexpr std::span<const u32> get_isolated_cpus() const noexcept { return m_isolated; }
+
+    u32 get_cpu_count() const noexcept;
+    u32 get_core_of(u32 cpu) const noexcept { return cpu < m_cpu_cores.size() ? m_cpu_cores[cpu] : s_invalid; }
+    u32 get_node_of(u32 cpu) const noexcept;
+    bool is_isolated(u32 cpu) const noexcept;
+
+    std::string describe() const;
+
+private:
+    std::vector<CpuCore> m_cores;
+    std::vector<NumaNode> m_nodes;
+    std::vector<CpuCache> m_caches;
+    CpuList m_isolated;
+    std::vector<u32> m_cpu_cores; // Logical CPU -> index into m_cores.
+};
+
+enum struct ThreadRole : u8
+{
+    Main,
+    Input,
+    Worker,
+    Io,
+    Log,
+};
+
+constexpr std::string_view to_string(ThreadRole role) noexcept
+{
+    constexpr std::string_view names[]{ "main", "input", "worker", "io", "log" };
+    return names[static_cast<u8>(role)];
+}
+
+struct AffinityPolicy
+{
+    // When false no thread is pinned and the pool gets one worker per allowed CPU beyond the first. Off by default:
+    // a thread starts with its creator's CPUs, so threads started from pinned framework threads without calling
+    // AffinityPlan::apply_current() share the pinned CPU.
+    bool enabled{ false };
+    // Place the main loop and input thread on isolcpus CPUs when the kernel has any.
+    bool use_isolated_cpus{ true };
+    // Keep the SMT siblings of the main and input CPUs free of other framework threads.
+    bool reserve_siblings{ true };
+    // Node the main loop, input, I/O and log threads run on.
+    u32 main_node{ 0u };
+    // Workers only on main_node rather than one per physical core on every node.
+    bool workers_on_main_node{ false };
+    // Zero for no limit.
+    u32 max_workers{ 0u };
+};
+
+struct ThreadPlacement
+{
+    ThreadRole role;
+    u32 index;
+    u32 node;
+    // Empty when the thread is left to the scheduler.
+    CpuList cpus;
+};
+
+// Where each framework thread runs, decided once from the topology and a policy. Threads place themselves through
+// apply_current() as they start; pinned threads also switch the memory pools to their node.
+class AffinityPlan
+{
+public:
+    AffinityPlan() : m_main(), m_input(), m_workers(), m_io(), m_log(), m_enabled(false) {}
+
+    static AffinityPlan build(const CpuTopology& topology, const AffinityPolicy& policy);
+
+    // The worker count ThreadPool should be created with.
+    u32 get_worker_count() const noexcept;
+    // Worker indices past the planned count wrap around.
+    const ThreadPlacement& get(ThreadRole role, u32 index = 0u) const noexcept;
+    std::vector<ThreadPlacement> get_placements() const;
+    constexpr bool is_enabled() const noexcept { return m_enabled; }
+
+    std::string describe() const;
+
+    // Places the calling thread; returns false if the OS refused. Roles the plan leaves unpinned get back every CPU
+    // the process may run on.
+    bool apply(ThreadRole role, u32 index = 0u) const;
+
+    // The plan framework threads place themselves by. Set it before starting threads that should follow it.
+    static void set_current(const AffinityPlan& plan);
+    static void clear_current();
+    static bool apply_current(ThreadRole role, u32 index = 0u);
+
+private:
+    ThreadPlacement m_main;
+    ThreadPlacement m_input;
+    std::vector<ThreadPlacement> m_workers;
+    ThreadPlacement m_io;
+    ThreadPlacement m_log;
+    bool m_enabled;
+};
+
+// Platform hooks, no-ops where unsupported.
+// The CPUs the process may run on, as they were at the first call; empty if unknown.
+const CpuList& get_process_cpus();
+bool set_thread_affinity(std::span<const u32> cpus) noexcept;
+// Prefers node for the pages of [ptr, ptr + size); ptr and size must be page-aligned.
+bool bind_memory_to_node(void* ptr, std::size_t size, u32 node) noexcept;
+
+} // namespace Surreal
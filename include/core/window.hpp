@@ -4,8 +4,10 @@
 #include "event.hpp"
 #include "exception.hpp"
 #include "flags.hpp"
-
-#include <vector>
+#include "hit_test.hpp"
+#include "input.hpp"
+#include "memory.hpp"
+#include "surface.hpp"
 
 namespace Surreal
 {
@@ -40,6 +42,8 @@ public:
 class Window
 {
 public:
+    SURREAL_TAGGED_NEW(MemoryTag::Window)
+
     virtual ~Window() = default;
 
     void push_event_handler(EventHandler* eh) { m_event_handlers.emplace_back(eh); }
@@ -48,15 +52,32 @@ public:
     virtual constexpr Position get_position() const noexcept = 0;
     virtual constexpr Rect get_rect() const noexcept = 0;
 
+    // Updated by on_update(); pressed/released cover the events drained by the last call.
+    constexpr const KeyboardState& get_keyboard() const noexcept { return m_keyboard; }
+
+    // Sized to the window. Drawn into during the frame and shown by present().
+    constexpr Surface& get_surface() noexcept { return m_surface; }
+    constexpr const Surface& get_surface() const noexcept { return m_surface; }
+
+    // Pointer events over a region go to its owner first and only reach the handler stack if the owner leaves them
+    // unhandled. Kept sized to the window; owners move their regions on WindowResizeEvent.
+    constexpr HitRegions& get_hit_regions() noexcept { return m_hit_regions; }
+    constexpr const HitRegions& get_hit_regions() const noexcept { return m_hit_regions; }
+
     virtual void on_update() = 0;
+    // Shows the surface if it was drawn into since the last call.
+    virtual void present() = 0;
     virtual void show() noexcept = 0;
     virtual void hide() noexcept = 0;
 
 protected:
-    Window(u64 id) : m_id(id), m_event_handlers() {}
+    Window(u64 id) : m_id(id), m_event_handlers(), m_keyboard(), m_surface(), m_hit_regions() {}
 
     u64 m_id;
-    std::vector<EventHandler*> m_event_handlers;
+    TaggedVector<EventHandler*, MemoryTag::Events> m_event_handlers;
+    KeyboardState m_keyboard;
+    Surface m_surface;
+    HitRegions m_hit_regions;
 };
 
 } // namespace Surreal
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <core/file.hpp>
+
+#include <linux/io_uring.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace Surreal
+{
+
+// Reads and writes through an io_uring instance driven with raw syscalls. A read on an eventfd stays armed in the ring
+// so wake() can interrupt wait() without a second blocking primitive.
+class IoUringQueue final : public AsyncReader, public AsyncWriter
+{
+public:
+    // Throws FileError if the kernel does not support the features used.
+    explicit IoUringQueue(u32 queue_depth);
+    ~IoUringQueue() override;
+
+    void read(FileHandle file, u64 offset, std::span<u8> buffer, u64 user) override;
+    void write(FileHandle file, u64 offset, std::span<const u8> buffer, u64 user) override;
+    void wait(std::vector<IoCompletion>& out) override;
+    void wake() noexcept override;
+
+    const char* get_name() const noexcept override { return "io_uring"; }
+
+private:
+    struct Operation
+    {
+        u8 opcode;
+        FileHandle file;
+        u64 offset;
+        u8* data;
+        std::size_t size;
+        u64 user;
+        std::size_t done;
+    };
+
+    static constexpr u64 s_wake_token{ ~u64(0) };
+
+    void start_operation(u8 opcode, FileHandle file, u64 offset, u8* data, std::size_t size, u64 user);
+    void push(u64 user_data, u8 opcode, FileHandle file, u64 offset, void* buffer, u32 size);
+    void push_operation(u32 slot);
+    void enter(u32 min_complete);
+    void release() noexcept;
+
+    int m_ring_fd;
+    int m_wake_fd;
+
+    void* m_ring;
+    std::size_t m_ring_size;
+    io_uring_sqe* m_sqes;
+    std::size_t m_sqes_size;
+
+    u32* m_sq_head;
+    u32* m_sq_tail;
+    u32* m_sq_array;
+    u32 m_sq_mask;
+    u32 m_sq_entries;
+    u32* m_cq_head;
+    u32* m_cq_tail;
+    u32 m_cq_mask;
+    io_uring_cqe* m_cqes;
+    u32 m_to_submit;
+
+    std::vector<Operation> m_operations;
+    std::vector<u32> m_free_slots;
+    u64 m_wake_value;
+};
+
+// Fallback queue: each operation is a blocking pread() or pwrite() on a pool worker.
+class ThreadPoolQueue final : public AsyncReader, public AsyncWriter
+{
+public:
+    explicit ThreadPoolQueue(ThreadPool& pool);
+    ~ThreadPoolQueue() override;
+
+    void read(FileHandle file, u64 offset, std::span<u8> buffer, u64 user) override;
+    void write(FileHandle file, u64 offset, std::span<const u8> buffer, u64 user) override;
+    void wait(std::vector<IoCompletion>& out) override;
+    void wake() noexcept override;
+
+    const char* get_name() const noexcept override { return "thread pool"; }
+
+private:
+    template <typename FuncTp>
+    void run(u64 user, FuncTp&& func);
+
+    ThreadPool& m_pool;
+
+    std::mutex m_mutex;
+    std::condition_variable m_signal;
+    std::vector<IoCompletion> m_completions;
+    u32 m_outstanding;
+    bool m_woken;
+};
+
+} // namespace Surreal
@@ -3,14 +3,18 @@
 #include <core/window.hpp>
 
 #include <core/event.hpp>
+#include <core/memory.hpp>
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_keysyms.h>
 #include <xcb/xcb_util.h>
+#include <xcb/xinput.h>
 
+#include <array>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace Surreal
 {
@@ -26,6 +30,7 @@ public:
     constexpr Rect get_rect() const noexcept override { return m_rect; }
 
     void on_update() override;
+    void present() override;
 
     void show() noexcept override;
     void hide() noexcept override;
@@ -33,6 +38,8 @@ public:
 private:
     Rect m_rect;
     xcb_window_t m_wid;
+    xcb_gcontext_t m_gc;
+    u8 m_depth;
 
     struct Atom
     {
@@ -41,23 +48,52 @@ private:
         u8 size;
     };
 
-    std::unordered_map<std::string_view, Atom> m_atoms;
+    TaggedUnorderedMap<std::string_view, Atom, MemoryTag::Window> m_atoms;
     xcb_atom_t m_wm_protocols_atom;
     xcb_atom_t m_wm_delete_window_atom;
 
+    // Keycode -> Key, rebuilt on MappingNotify so the event path never queries the X server.
+    std::array<Key, 256> m_keymap;
+    xcb_key_symbols_t* m_key_symbols;
+
+    // X reports auto-repeat as a release/press pair with the same timestamp. A release is held back until the next
+    // event shows whether it is real.
+    xcb_key_release_event_t m_pending_release;
+    bool m_has_pending_release;
+
+    // Pointer state accumulated while draining events and handed to the handlers once per frame.
+    TaggedVector<MouseRawSample, MemoryTag::Events> m_raw_motion;
+    Position m_pointer_pos;
+    bool m_pointer_moved;
+    bool m_pointer_tracked;
+    bool m_focused;
+
 private:
     static xcb_connection_t* s_connection;
     static u32 s_window_count;
+    // Major opcode of the XInput extension, zero if XInput 2.2 is unavailable.
+    static u8 s_xinput_opcode;
 
     static constexpr std::string_view s_wm_protocols_name{ "WM_PROTOCOLS" };
     static constexpr std::string_view s_wm_delete_window_name{ "WM_DELETE_WINDOW" };
 
     void on_client_message(xcb_client_message_event_t*);
     void on_configure_notify(xcb_configure_notify_event_t*);
+    void on_expose(xcb_expose_event_t*);
     void on_key_press(xcb_key_press_event_t*);
     void on_key_release(xcb_key_release_event_t*);
+    void on_mapping_notify(xcb_mapping_notify_event_t*);
     void on_button_press(xcb_button_press_event_t*);
     void on_button_release(xcb_button_release_event_t*);
+    void on_motion_notify(xcb_motion_notify_event_t*);
+    void on_focus_change(bool focused);
+    void on_generic_event(xcb_ge_generic_event_t*);
+    void on_raw_motion(xcb_input_raw_motion_event_t*);
+
+    void build_keymap();
+    void flush_pending_release();
+    void select_raw_motion(xcb_window_t root);
+    void flush_pointer_motion();
 };
 
 } // namespace Surreal
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <core/application.hpp>
+#include <core/math.hpp>
+#include <core/memory.hpp>
+#include <core/text.hpp>
 #include <core/window.hpp>
 
 #define SURREAL_DEFINE_APP_ENTRY(app_class)                                                                            \
@@ -12,4 +15,5 @@
         auto app = new app_class();                                                                                    \
         app->run();                                                                                                    \
         delete app;                                                                                                    \
+        Surreal::Memory::report_leaks();                                                                               \
     }
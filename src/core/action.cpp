@@ -0,0 +1,269 @@
+#include <core/action.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <fmt/format.h>
+
+namespace Surreal
+{
+
+static constexpr std::size_t s_max_ids{ std::numeric_limits<u16>::max() };
+
+ActionId ActionBindings::add_action(std::string name)
+{
+    if (m_action_names.size() >= s_max_ids)
+        throw ActionError("Too many actions.");
+    if (find_action(name) != static_cast<ActionId>(s_max_ids))
+        throw ActionError(fmt::format("Action \"{}\" is already declared.", name));
+
+    m_action_names.emplace_back(std::move(name));
+    return static_cast<ActionId>(m_action_names.size() - 1u);
+}
+
+AxisId ActionBindings::add_axis(std::string name)
+{
+    if (m_axis_names.size() >= s_max_ids)
+        throw ActionError("Too many axes.");
+    if (find_axis(name) != static_cast<AxisId>(s_max_ids))
+        throw ActionError(fmt::format("Axis \"{}\" is already declared.", name));
+
+    m_axis_names.emplace_back(std::move(name));
+    return static_cast<AxisId>(m_axis_names.size() - 1u);
+}
+
+void ActionBindings::bind(ActionId action, Key key, ModifierFlags modifiers)
+{
+    if (action >= m_action_names.size() || key >= Key::Count)
+        throw ActionError("Invalid action or key in key binding.");
+
+    m_key_bindings.push_back({ action, key, modifiers });
+}
+
+void ActionBindings::bind(ActionId action, MouseButton button, ModifierFlags modifiers)
+{
+    if (action >= m_action_names.size() || button > MouseButton::Unknown)
+        throw ActionError("Invalid action or button in button binding.");
+
+    m_button_bindings.push_back({ action, button, modifiers });
+}
+
+void ActionBindings::bind_axis(AxisId axis, Key key, f32 scale)
+{
+    if (axis >= m_axis_names.size() || key >= Key::Count)
+        throw ActionError("Invalid axis or key in axis binding.");
+
+    m_axis_bindings.push_back({ axis, key, scale });
+}
+
+// Returns an out-of-range id if the name is unknown.
+ActionId ActionBindings::find_action(std::string_view name) const
+{
+    auto it{ std::find(m_action_names.begin(), m_action_names.end(), name) };
+    return it == m_action_names.end() ? static_cast<ActionId>(s_max_ids)
+                                      : static_cast<ActionId>(it - m_action_names.begin());
+}
+
+AxisId ActionBindings::find_axis(std::string_view name) const
+{
+    auto it{ std::find(m_axis_names.begin(), m_axis_names.end(), name) };
+    return it == m_axis_names.end() ? static_cast<AxisId>(s_max_ids) : static_cast<AxisId>(it - m_axis_names.begin());
+}
+
+// Counting sort of the bindings by key (or button) into CSR-style offset/target arrays.
+template <typename BindingTp, typename TargetTp, std::size_t SlotCount, typename SlotFunc, typename TargetFunc>
+static void build_ranges(const std::vector<BindingTp>& bindings, std::array<u32, SlotCount>& offsets,
+                         std::vector<TargetTp>& targets, SlotFunc slot_of, TargetFunc target_of)
+{
+    offsets.fill(0u);
+    for (const auto& binding : bindings)
+        ++offsets[slot_of(binding) + 1u];
+    for (std::size_t i{ 1u }; i < SlotCount; ++i)
+        offsets[i] += offsets[i - 1u];
+
+    std::array<u32, SlotCount> cursor{ offsets };
+    targets.resize(bindings.size());
+    for (std::size_t i{ 0u }; i < bindings.size(); ++i)
+        targets[cursor[slot_of(bindings[i])]++] = target_of(bindings[i], i);
+}
+
+ActionTable::ActionTable(const ActionBindings& bindings)
+    : m_key_offsets(), m_button_offsets(), m_axis_offsets(), m_key_targets(), m_button_targets(), m_axis_targets(),
+      m_binding_actions(), m_action_count(bindings.m_action_names.size()), m_axis_count(bindings.m_axis_names.size())
+{
+    const std::size_t key_binding_count{ bindings.m_key_bindings.size() };
+
+    m_binding_actions.reserve(key_binding_count + bindings.m_button_bindings.size());
+    for (const auto& binding : bindings.m_key_bindings)
+        m_binding_actions.push_back(binding.action);
+    for (const auto& binding : bindings.m_button_bindings)
+        m_binding_actions.push_back(binding.action);
+
+    build_ranges(
+        bindings.m_key_bindings, m_key_offsets, m_key_targets,
+        [](const ActionBindings::KeyBinding& b) { return static_cast<std::size_t>(b.key); },
+        [](const ActionBindings::KeyBinding& b, std::size_t i) { return Target{ static_cast<u16>(i), b.modifiers }; });
+
+    build_ranges(
+        bindings.m_button_bindings, m_button_offsets, m_button_targets,
+        [](const ActionBindings::ButtonBinding& b) { return static_cast<std::size_t>(b.button); },
+        [key_binding_count](const ActionBindings::ButtonBinding& b, std::size_t i) {
+            return Target{ static_cast<u16>(key_binding_count + i), b.modifiers };
+        });
+
+    build_ranges(
+        bindings.m_axis_bindings, m_axis_offsets, m_axis_targets,
+        [](const ActionBindings::AxisBinding& b) { return static_cast<std::size_t>(b.key); },
+        [](const ActionBindings::AxisBinding& b, SURREAL_UNUSED(std::size_t, i)) {
+            return AxisTarget{ b.axis, b.scale };
+        });
+
+    if (m_binding_actions.size() > s_max_ids)
+        throw ActionError("Too many bindings.");
+}
+
+ActionMap::ActionMap()
+    : m_table(std::make_shared<const ActionTable>(ActionBindings())), m_states(), m_axis_values(), m_binding_active(),
+      m_active_counts(), m_keys(), m_pending_mutex(), m_pending_table()
+{
+}
+
+void ActionMap::set_bindings(const ActionBindings& bindings)
+{
+    auto table{ std::make_shared<const ActionTable>(bindings) };
+
+    std::scoped_lock lock{ m_pending_mutex };
+    m_pending_table = std::move(table);
+}
+
+void ActionMap::begin_frame()
+{
+    for (auto& state : m_states)
+    {
+        state.pressed = false;
+        state.released = false;
+    }
+
+    // Never wait on a set_bindings() in progress; the table is picked up next frame instead.
+    std::unique_lock lock{ m_pending_mutex, std::try_to_lock };
+    if (lock && m_pending_table)
+    {
+        auto table{ std::move(m_pending_table) };
+        lock.unlock();
+        swap_table(std::move(table));
+    }
+}
+
+void ActionMap::swap_table(std::shared_ptr<const ActionTable> table)
+{
+    for (auto& state : m_states)
+    {
+        state.released = state.down;
+        state.down = false;
+    }
+
+    m_table = std::move(table);
+    m_states.resize(m_table->get_action_count(), ActionState{ false, false, false });
+    m_axis_values.assign(m_table->get_axis_count(), 0.0f);
+    m_binding_active.assign(m_table->get_binding_actions().size(), 0u);
+    m_active_counts.assign(m_table->get_action_count(), 0u);
+
+    for (std::size_t i{ 0u }; i < KeyboardState::s_key_count; ++i)
+    {
+        const Key key{ static_cast<Key>(i) };
+        if (m_keys.is_down(key))
+            for (const auto& target : m_table->get_axis_targets(key))
+                m_axis_values[target.axis] += target.scale;
+    }
+}
+
+void ActionMap::activate(std::span<const ActionTable::Target> targets)
+{
+    const ModifierFlags modifiers{ get_modifiers() };
+    const auto binding_actions{ m_table->get_binding_actions() };
+
+    for (const auto& target : targets)
+    {
+        if (target.modifiers != modifiers || m_binding_active[target.index])
+            continue;
+
+        m_binding_active[target.index] = 1u;
+        const ActionId action{ binding_actions[target.index] };
+        if (!m_active_counts[action]++)
+        {
+            m_states[action].down = true;
+            m_states[action].pressed = true;
+        }
+    }
+}
+
+// Modifiers are not checked on release, so letting go of Ctrl before S still ends a Ctrl+S action when S is released.
+void ActionMap::deactivate(std::span<const ActionTable::Target> targets)
+{
+    const auto binding_actions{ m_table->get_binding_actions() };
+
+    for (const auto& target : targets)
+    {
+        if (!m_binding_active[target.index])
+            continue;
+
+        m_binding_active[target.index] = 0u;
+        const ActionId action{ binding_actions[target.index] };
+        if (!--m_active_counts[action])
+        {
+            m_states[action].down = false;
+            m_states[action].released = true;
+        }
+    }
+}
+
+ModifierFlags ActionMap::get_modifiers() const noexcept
+{
+    ModifierFlags modifiers{};
+    for (Key key : { Key::LeftShift, Key::RightShift, Key::LeftControl, Key::RightControl, Key::LeftAlt,
+                     Key::RightAlt, Key::LeftSuper, Key::RightSuper })
+    {
+        if (m_keys.is_down(key))
+            modifiers |= to_modifier(key);
+    }
+    return modifiers;
+}
+
+void ActionMap::operator()(KeyEvent& ke)
+{
+    const Key key{ ke.get_key() };
+    if (key == Key::Unknown)
+        return;
+
+    if (ke.get_type() == EventType::KeyPress)
+    {
+        if (!m_keys.press(key))
+            return;
+
+        for (const auto& target : m_table->get_axis_targets(key))
+            m_axis_values[target.axis] += target.scale;
+        activate(m_table->get_key_targets(key));
+    }
+    else if (ke.get_type() == EventType::KeyRelease)
+    {
+        if (!m_keys.is_down(key))
+            return;
+
+        m_keys.release(key);
+        for (const auto& target : m_table->get_axis_targets(key))
+            m_axis_values[target.axis] -= target.scale;
+        deactivate(m_table->get_key_targets(key));
+    }
+}
+
+void ActionMap::operator()(MouseEvent& me)
+{
+    if (me.get_type() == EventType::MouseButtonPress)
+        activate(m_table->get_button_targets(static_cast<MouseButtonEvent&>(me).get_button()));
+    else if (me.get_type() == EventType::MouseButtonRelease)
+        deactivate(m_table->get_button_targets(static_cast<MouseButtonEvent&>(me).get_button()));
+}
+
+void ActionMap::operator()(SURREAL_UNUSED(WindowEvent&, we)) {}
+
+} // namespace Surreal
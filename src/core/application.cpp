@@ -1,10 +1,12 @@
 #include <core/application.hpp>
+#include <core/log.hpp>
 
 #if SURREAL_PLATFORM_LINUX
     #include <platform/linux/window.hpp>
 #endif
 
 #include <chrono>
+#include <filesystem>
 
 #include <fmt/format.h>
 
@@ -13,13 +15,25 @@ namespace Surreal
 
 Application* Application::s_instance{ nullptr };
 
-Application::Application() : m_should_quit(false), m_window(nullptr)
+Application::Application(const AffinityPolicy& policy)
+    : m_should_quit(false), m_window(nullptr), m_actions(),
+      m_affinity(AffinityPlan::build(CpuTopology::detect(), policy)),
+      m_thread_pool(m_affinity.get_worker_count()), m_world(), m_systems(m_world, m_thread_pool),
+      m_capture_settings(), m_capture(nullptr), m_capture_segment(0u)
 {
     s_instance = this;
+
+    // Before any framework thread starts, so each can place itself as it comes up.
+    AffinityPlan::set_current(m_affinity);
+    m_affinity.apply(ThreadRole::Main);
+    Log::start();
+    SURREAL_LOG_INFO("Thread placement:\n{}", m_affinity.describe());
 }
 
 Application::~Application()
 {
+    Log::stop();
+    AffinityPlan::clear_current();
     s_instance = nullptr;
 }
 
@@ -31,7 +45,10 @@ void Application::run()
 #if SURREAL_PLATFORM_LINUX
     m_window = new LinuxWindow("Titan Application", WindowCreateFlagBits::VSync);
 #endif
+    m_window->push_event_handler(&m_actions);
     m_window->push_event_handler(this);
+    if (m_capture_settings)
+        start_capture(*m_capture_settings);
 
     float elapsed_time{ 0.0f };
     auto start_time{ Clock::now() };
@@ -42,13 +59,64 @@ void Application::run()
         Seconds delta_time{ end_time - start_time };
 
         on_update(delta_time.count());
+        m_systems.run(delta_time.count());
+        m_window->present();
+        if (m_capture)
+            m_capture->submit(m_window->get_surface());
+        m_actions.begin_frame();
         m_window->on_update();
+        Memory::check_budgets();
 
         elapsed_time += delta_time.count();
         start_time = end_time;
     }
 
+    m_capture.reset();
     delete m_window;
+    m_window = nullptr;
+}
+
+void Application::start_capture(const CaptureSettings& settings)
+{
+    m_capture.reset();
+    m_capture_settings = settings;
+    m_capture_segment = 0u;
+    if (m_window)
+        m_capture = std::make_unique<FrameCapture>(settings, m_window->get_surface().get_size(), m_thread_pool);
+}
+
+void Application::stop_capture()
+{
+    m_capture.reset();
+    m_capture_settings.reset();
+}
+
+void Application::restart_capture(Size size)
+{
+    const Size frame_size{ m_capture ? m_capture->get_frame_size() : Size{ 0u, 0u } };
+    if (frame_size.w == size.w && frame_size.h == size.h)
+        return;
+
+    m_capture.reset();
+    // A minimised window has nothing to record; the next resize picks the recording up again.
+    if (!size.w || !size.h)
+        return;
+
+    const std::filesystem::path first{ m_capture_settings->path };
+    CaptureSettings settings{ *m_capture_settings };
+    settings.path = (first.parent_path() / fmt::format("{}.{}{}", first.stem().string(), ++m_capture_segment,
+                                                       first.extension().string()))
+                        .string();
+    try
+    {
+        m_capture = std::make_unique<FrameCapture>(settings, size, m_thread_pool);
+    }
+    catch (const RuntimeError& e)
+    {
+        SURREAL_LOG_ERROR("Capture stopped: cannot continue at {}x{} in {}: {}", size.w, size.h, settings.path,
+                          e.what());
+        m_capture_settings.reset();
+    }
 }
 
 void Application::on_update(SURREAL_UNUSED(float, delta_time)) {}
@@ -58,7 +126,7 @@ void Application::operator()(KeyEvent& ke)
     if (ke.get_type() == EventType::KeyPress)
     {
         auto& kp{ static_cast<KeyPressEvent&>(ke) };
-        if (kp.get_key() == 9)
+        if (kp.get_key() == Key::Escape)
         {
             m_should_quit = true;
             kp.handled = true;
@@ -67,6 +135,8 @@ void Application::operator()(KeyEvent& ke)
     }
 }
 
+void Application::operator()(SURREAL_UNUSED(MouseEvent&, me)) {}
+
 void Application::operator()(WindowEvent& we)
 {
     if (we.get_type() == EventType::WindowClose)
@@ -76,6 +146,9 @@ void Application::operator()(WindowEvent& we)
         wc.handled = true;
         return;
     }
+
+    if (we.get_type() == EventType::WindowResize && m_capture_settings)
+        restart_capture(static_cast<WindowResizeEvent&>(we).get_size());
 }
 
 // void Application::process_key_event(KeyEvent& ke)
@@ -0,0 +1,423 @@
+#include <core/asset.hpp>
+#include <core/log.hpp>
+#include <core/lz4.hpp>
+#include <core/topology.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace Surreal
+{
+
+static constexpr u64 align_up(u64 value, u64 alignment) noexcept
+{
+    return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+// Checks offset + size <= limit without overflowing.
+static constexpr bool in_bounds(u64 offset, u64 size, u64 limit) noexcept
+{
+    return offset <= limit && size <= limit - offset;
+}
+
+AssetPack::AssetPack(const std::string& path) : m_file(path), m_entries(), m_names()
+{
+    const std::span<const u8> bytes{ m_file.get_bytes() };
+
+    PackHeader header;
+    if (bytes.size() < sizeof(header))
+        throw AssetError(path + " is too small to be an asset pack.");
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (header.magic != PackHeader::s_magic)
+        throw AssetError(path + " is not an asset pack.");
+    if (header.version != PackHeader::s_version)
+        throw AssetError(path + " has unsupported pack version " + std::to_string(header.version) + ".");
+
+    const u64 toc_size{ u64(header.entry_count) * sizeof(PackEntry) };
+    if (header.toc_offset % alignof(PackEntry) || !in_bounds(header.toc_offset, toc_size, bytes.size()) ||
+        !in_bounds(header.names_offset, header.names_size, bytes.size()))
+        throw AssetError(path + " has a corrupt table of contents.");
+
+    m_entries = { reinterpret_cast<const PackEntry*>(bytes.data() + header.toc_offset), header.entry_count };
+    m_names = { reinterpret_cast<const char*>(bytes.data() + header.names_offset), header.names_size };
+
+    for (std::size_t i{ 0u }; i < m_entries.size(); ++i)
+    {
+        const PackEntry& entry{ m_entries[i] };
+        const bool valid{ in_bounds(entry.name_offset, entry.name_length, m_names.size()) &&
+                          in_bounds(entry.offset, entry.stored_size, bytes.size()) &&
+                          ((entry.compression == AssetCompression::Lz4 &&
+                            entry.size <= lz4_decompress_bound(entry.stored_size)) ||
+                           (entry.compression == AssetCompression::None && entry.stored_size == entry.size)) &&
+                          (!i || m_entries[i - 1u].name_hash < entry.name_hash) };
+        if (!valid)
+            throw AssetError(path + " has a corrupt entry at index " + std::to_string(i) + ".");
+    }
+}
+
+const PackEntry* AssetPack::find(std::string_view name) const noexcept
+{
+    const u64 hash{ hash_asset_name(name) };
+    const auto it{ std::lower_bound(m_entries.begin(), m_entries.end(), hash,
+                                    [](const PackEntry& entry, u64 h) { return entry.name_hash < h; }) };
+    if (it == m_entries.end() || it->name_hash != hash || get_name(*it) != name)
+        return nullptr;
+    return &*it;
+}
+
+std::string_view AssetPack::get_name(const PackEntry& entry) const noexcept
+{
+    return m_names.substr(entry.name_offset, entry.name_length);
+}
+
+std::span<const u8> AssetPack::get_stored(const PackEntry& entry) const noexcept
+{
+    return m_file.get_bytes().subspan(entry.offset, entry.stored_size);
+}
+
+std::vector<u8> AssetPack::load(const PackEntry& entry) const
+{
+    const std::span<const u8> stored{ get_stored(entry) };
+    if (entry.compression == AssetCompression::None)
+        return { stored.begin(), stored.end() };
+
+    std::vector<u8> data(entry.size);
+    if (!lz4_decompress(stored, data))
+        throw AssetError("Asset " + std::string(get_name(entry)) + " is corrupt.");
+    return data;
+}
+
+AssetPackBuilder::AssetPackBuilder(u32 alignment) : m_alignment(alignment), m_assets()
+{
+    if (alignment < alignof(PackEntry) || !std::has_single_bit(alignment))
+        throw AssetError("Pack alignment must be a power of two of at least 8.");
+}
+
+void AssetPackBuilder::add(std::string name, std::vector<u8> data, AssetCompression compression)
+{
+    if (name.size() > 0xffffu)
+        throw AssetError("Asset name is too long: " + name);
+
+    const u64 hash{ hash_asset_name(name) };
+    for (const Asset& asset : m_assets)
+    {
+        if (asset.hash == hash)
+            throw AssetError(asset.name == name ? "Duplicate asset " + name
+                                                : "Asset names " + asset.name + " and " + name + " collide.");
+    }
+
+    m_assets.push_back({ std::move(name), hash, std::move(data), compression });
+}
+
+void AssetPackBuilder::write(const std::string& path, ThreadPool& pool) const
+{
+    std::vector<const Asset*> sorted;
+    sorted.reserve(m_assets.size());
+    for (const Asset& asset : m_assets)
+        sorted.push_back(&asset);
+    std::sort(sorted.begin(), sorted.end(), [](const Asset* a, const Asset* b) { return a->hash < b->hash; });
+
+    std::vector<std::vector<u8>> compressed(sorted.size());
+    pool.parallel_for(static_cast<u32>(sorted.size()), [&](u32 i) {
+        const Asset& asset{ *sorted[i] };
+        if (asset.compression != AssetCompression::Lz4 || asset.data.empty())
+            return;
+
+        std::vector<u8> out(lz4_compress_bound(asset.data.size()));
+        out.resize(lz4_compress(asset.data, out));
+        if (out.size() < asset.data.size())
+            compressed[i] = std::move(out);
+    });
+
+    PackHeader header{};
+    header.magic = PackHeader::s_magic;
+    header.version = PackHeader::s_version;
+    header.entry_count = static_cast<u32>(sorted.size());
+    header.alignment = m_alignment;
+    header.toc_offset = sizeof(PackHeader);
+    header.names_offset = header.toc_offset + sorted.size() * sizeof(PackEntry);
+
+    std::vector<PackEntry> entries(sorted.size());
+    std::string names;
+    u64 offset{ 0u };
+    for (std::size_t i{ 0u }; i < sorted.size(); ++i)
+    {
+        const Asset& asset{ *sorted[i] };
+        const bool is_compressed{ !compressed[i].empty() };
+
+        PackEntry& entry{ entries[i] };
+        entry.name_hash = asset.hash;
+        entry.offset = offset; // Relative to data_offset until it is known.
+        entry.stored_size = is_compressed ? compressed[i].size() : asset.data.size();
+        entry.size = asset.data.size();
+        entry.name_offset = static_cast<u32>(names.size());
+        entry.name_length = static_cast<u16>(asset.name.size());
+        entry.compression = is_compressed ? AssetCompression::Lz4 : AssetCompression::None;
+
+        names += asset.name;
+        offset = align_up(offset + entry.stored_size, m_alignment);
+    }
+
+    header.names_size = names.size();
+    header.data_offset = align_up(header.names_offset + header.names_size, m_alignment);
+    for (PackEntry& entry : entries)
+        entry.offset += header.data_offset;
+
+    // Written beside the destination and renamed over it, so readers never map a half-written pack.
+    const std::string temp_path{ path + ".tmp" };
+    std::FILE* file{ std::fopen(temp_path.c_str(), "wb") };
+    if (!file)
+        throw AssetError("Failed to open " + temp_path + " for writing.");
+
+    u64 position{ 0u };
+    bool ok{ true };
+    auto put{ [&](const void* data, std::size_t size) {
+        ok = ok && std::fwrite(data, 1u, size, file) == size;
+        position += size;
+    } };
+    auto pad_to{ [&](u64 target) {
+        static constexpr u8 s_zeros[256]{};
+        while (ok && position < target)
+            put(s_zeros, static_cast<std::size_t>(std::min<u64>(target - position, sizeof(s_zeros))));
+    } };
+
+    put(&header, sizeof(header));
+    put(entries.data(), entries.size() * sizeof(PackEntry));
+    put(names.data(), names.size());
+    for (std::size_t i{ 0u }; i < sorted.size(); ++i)
+    {
+        pad_to(entries[i].offset);
+        const std::vector<u8>& blob{ compressed[i].empty() ? sorted[i]->data : compressed[i] };
+        put(blob.data(), blob.size());
+    }
+
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        std::remove(temp_path.c_str());
+        throw AssetError("Failed to write " + temp_path + ".");
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error)
+        throw AssetError("Failed to move " + temp_path + " to " + path + ": " + error.message());
+}
+
+AssetStreamer::AssetStreamer(const AssetPack& pack, ThreadPool& pool, u32 max_in_flight)
+    : m_pack(pack), m_pool(pool), m_max_in_flight(std::max(max_in_flight, 1u)),
+      m_reader(AsyncReader::create(pool, m_max_in_flight)), m_callbacks(), m_next_id(0u), m_queue_mutex(),
+      m_queue_signal(), m_queue(), m_stopping(false), m_in_flight(), m_done_mutex(), m_done_signal(), m_done(),
+      m_decompressing(0u), m_io_thread()
+{
+    m_io_thread = std::thread([this] {
+        AffinityPlan::apply_current(ThreadRole::Io);
+        io_loop();
+    });
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    {
+        std::scoped_lock lock{ m_queue_mutex };
+        m_stopping = true;
+    }
+    m_queue_signal.notify_one();
+    m_reader->wake();
+    m_io_thread.join();
+
+    std::unique_lock lock{ m_done_mutex };
+    m_done_signal.wait(lock, [this] { return !m_decompressing; });
+}
+
+bool AssetStreamer::is_lower_priority(const RequestPtr& a, const RequestPtr& b) noexcept
+{
+    return a->priority < b->priority || (a->priority == b->priority && a->id > b->id);
+}
+
+StreamRequestId AssetStreamer::request(const PackEntry& entry, i32 priority, Callback on_complete)
+{
+    auto request{ std::allocate_shared<Request>(TaggedAllocator<Request, MemoryTag::Assets>()) };
+    request->id = ++m_next_id;
+    request->entry = &entry;
+    request->priority = priority;
+    m_callbacks.emplace(request->id, std::make_pair(request, std::move(on_complete)));
+
+    if (entry.compression == AssetCompression::None)
+    {
+        m_pack.get_file().prefetch(entry.offset, entry.stored_size);
+        finish(request, { request->id, &entry, StreamStatus::Completed, m_pack.get_stored(entry), {}, {} });
+        return request->id;
+    }
+
+    {
+        std::scoped_lock lock{ m_queue_mutex };
+        m_queue.push_back(request);
+        std::push_heap(m_queue.begin(), m_queue.end(), is_lower_priority);
+    }
+    m_queue_signal.notify_one();
+    m_reader->wake();
+    return request->id;
+}
+
+bool AssetStreamer::cancel(StreamRequestId id)
+{
+    const auto it{ m_callbacks.find(id) };
+    if (it == m_callbacks.end())
+        return false;
+
+    // Queued requests are skipped when they reach the top of the heap.
+    it->second.first->cancelled.store(true, std::memory_order_relaxed);
+    m_callbacks.erase(it);
+    return true;
+}
+
+u32 AssetStreamer::poll()
+{
+    std::vector<StreamResult> done;
+    {
+        std::scoped_lock lock{ m_done_mutex };
+        done.swap(m_done);
+    }
+
+    u32 count{ 0u };
+    for (StreamResult& result : done)
+    {
+        const auto it{ m_callbacks.find(result.id) };
+        if (it == m_callbacks.end())
+            continue;
+
+        Callback callback{ std::move(it->second.second) };
+        m_callbacks.erase(it);
+        callback(result);
+        ++count;
+    }
+    return count;
+}
+
+void AssetStreamer::io_loop()
+{
+    std::vector<AsyncReader::Completion> completions;
+
+    while (true)
+    {
+        dispatch_reads();
+
+        if (m_in_flight.empty())
+        {
+            std::unique_lock lock{ m_queue_mutex };
+            if (m_stopping)
+                return;
+            m_queue_signal.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            continue;
+        }
+
+        completions.clear();
+        try
+        {
+            m_reader->wait(completions);
+        }
+        catch (const FileError& e)
+        {
+            SURREAL_LOG_ERROR("Asset streaming failed: {}", e.what());
+            for (auto& [id, request] : m_in_flight)
+                finish(request, { id, request->entry, StreamStatus::Failed, {}, {}, e.what() });
+            m_in_flight.clear();
+        }
+
+        for (const AsyncReader::Completion& completion : completions)
+        {
+            const auto it{ m_in_flight.find(completion.user) };
+            if (it == m_in_flight.end()) SURREAL_UNLIKELY
+                continue;
+
+            RequestPtr request{ std::move(it->second) };
+            m_in_flight.erase(it);
+            on_read(request, completion.error);
+        }
+    }
+}
+
+// Moves the highest-priority queued requests into the reader until max_in_flight reads are outstanding.
+void AssetStreamer::dispatch_reads()
+{
+    while (m_in_flight.size() < m_max_in_flight)
+    {
+        RequestPtr request;
+        {
+            std::scoped_lock lock{ m_queue_mutex };
+            if (m_stopping || m_queue.empty())
+                return;
+
+            std::pop_heap(m_queue.begin(), m_queue.end(), is_lower_priority);
+            request = std::move(m_queue.back());
+            m_queue.pop_back();
+        }
+
+        if (request->cancelled.load(std::memory_order_relaxed))
+            continue;
+
+        const PackEntry& entry{ *request->entry };
+        request->buffer.resize(entry.stored_size);
+        m_in_flight.emplace(request->id, request);
+        m_reader->read(m_pack.get_file().get_handle(), entry.offset, request->buffer, request->id);
+    }
+}
+
+void AssetStreamer::on_read(const RequestPtr& request, i32 error)
+{
+    if (request->cancelled.load(std::memory_order_relaxed))
+        return;
+
+    const PackEntry& entry{ *request->entry };
+    if (error)
+    {
+        finish(request, { request->id, &entry, StreamStatus::Failed, {}, {}, std::strerror(error) });
+        return;
+    }
+
+    {
+        std::scoped_lock lock{ m_done_mutex };
+        ++m_decompressing;
+    }
+
+    m_pool.submit([this, request, &entry] {
+        // The pool does not catch exceptions, so a failed allocation is reported like any other failure.
+        try
+        {
+            if (!request->cancelled.load(std::memory_order_relaxed))
+            {
+                std::vector<u8> data(entry.size);
+                if (lz4_decompress(request->buffer, data))
+                {
+                    const std::span<const u8> view{ data };
+                    finish(request, { request->id, &entry, StreamStatus::Completed, view, std::move(data), {} });
+                }
+                else
+                    finish(request, { request->id, &entry, StreamStatus::Failed, {}, {}, "corrupt compressed data" });
+            }
+        }
+        catch (const std::exception& e)
+        {
+            finish(request, { request->id, &entry, StreamStatus::Failed, {}, {}, e.what() });
+        }
+
+        // Notified under the lock: the destructor may return as soon as it sees the count drop.
+        std::scoped_lock lock{ m_done_mutex };
+        --m_decompressing;
+        m_done_signal.notify_all();
+    });
+}
+
+void AssetStreamer::finish(const RequestPtr& request, StreamResult result)
+{
+    request->buffer = {};
+    std::scoped_lock lock{ m_done_mutex };
+    m_done.push_back(std::move(result));
+}
+
+} // namespace Surreal
@@ -0,0 +1,512 @@
+#include <core/capture.hpp>
+#include <core/log.hpp>
+#include <core/topology.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <fmt/format.h>
+
+namespace Surreal
+{
+
+// Large enough that a direct write streams at full disk speed, small enough that four of them are cheap to keep.
+static constexpr std::size_t s_chunk_size{ 4u * 1024u * 1024u };
+static constexpr u32 s_chunk_count{ 4u };
+
+static constexpr std::size_t align_up(std::size_t size, std::size_t alignment) noexcept
+{
+    return (size + alignment - 1u) / alignment * alignment;
+}
+
+// Worst case of every format: QOI spends 4 bytes on each RGB pixel that matches nothing.
+static std::size_t get_max_encoded_size(Size size) noexcept
+{
+    const std::size_t pixels{ static_cast<std::size_t>(size.w) * size.h };
+    return pixels * 4u + 64u;
+}
+
+static u8* encode_raw(std::span<const Pixel> pixels, u8* out) noexcept
+{
+    std::memcpy(out, pixels.data(), pixels.size_bytes());
+    return out + pixels.size_bytes();
+}
+
+static constexpr u8 clamp_u8(i32 value) noexcept
+{
+    return static_cast<u8>(std::clamp(value, 0, 255));
+}
+
+// Full-range BT.601, the JPEG flavour, with chroma from the average of each 2x2 block.
+static u8* encode_y4m(std::span<const Pixel> pixels, Size size, u8* out) noexcept
+{
+    constexpr std::string_view frame_header{ "FRAME\n" };
+    out = std::copy(frame_header.begin(), frame_header.end(), out);
+
+    for (const Pixel p : pixels)
+    {
+        const i32 r{ static_cast<i32>((p >> 16u) & 0xffu) };
+        const i32 g{ static_cast<i32>((p >> 8u) & 0xffu) };
+        const i32 b{ static_cast<i32>(p & 0xffu) };
+        *out++ = clamp_u8((77 * r + 150 * g + 29 * b + 128) >> 8);
+    }
+
+    const u32 chroma_w{ (size.w + 1u) / 2u };
+    const u32 chroma_h{ (size.h + 1u) / 2u };
+    u8* cb_plane{ out };
+    u8* cr_plane{ out + static_cast<std::size_t>(chroma_w) * chroma_h };
+    for (u32 cy{ 0u }; cy < chroma_h; ++cy)
+    {
+        const Pixel* row0{ pixels.data() + static_cast<std::size_t>(cy * 2u) * size.w };
+        const Pixel* row1{ cy * 2u + 1u < size.h ? row0 + size.w : row0 };
+        for (u32 cx{ 0u }; cx < chroma_w; ++cx)
+        {
+            const u32 x0{ cx * 2u };
+            const u32 x1{ x0 + 1u < size.w ? x0 + 1u : x0 };
+            const Pixel block[]{ row0[x0], row0[x1], row1[x0], row1[x1] };
+
+            i32 r{ 0 }, g{ 0 }, b{ 0 };
+            for (const Pixel p : block)
+            {
+                r += static_cast<i32>((p >> 16u) & 0xffu);
+                g += static_cast<i32>((p >> 8u) & 0xffu);
+                b += static_cast<i32>(p & 0xffu);
+            }
+            // The sums are four pixels' worth; fold the averaging into the shift.
+            *cb_plane++ = clamp_u8(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128);
+            *cr_plane++ = clamp_u8(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128);
+        }
+    }
+    return cr_plane;
+}
+
+static u8* write_u32_be(u8* out, u32 value) noexcept
+{
+    *out++ = static_cast<u8>(value >> 24u);
+    *out++ = static_cast<u8>(value >> 16u);
+    *out++ = static_cast<u8>(value >> 8u);
+    *out++ = static_cast<u8>(value);
+    return out;
+}
+
+// The reference QOI encoder, specialised to opaque RGB: alpha is forced to 255, so QOI_OP_RGBA never comes up.
+static u8* encode_qoi(std::span<const Pixel> pixels, Size size, u8* out) noexcept
+{
+    constexpr u8 op_index{ 0x00u };
+    constexpr u8 op_diff{ 0x40u };
+    constexpr u8 op_luma{ 0x80u };
+    constexpr u8 op_run{ 0xc0u };
+    constexpr u8 op_rgb{ 0xfeu };
+
+    out = std::copy_n("qoif", 4u, out);
+    out = write_u32_be(out, size.w);
+    out = write_u32_be(out, size.h);
+    *out++ = 3u; // RGB
+    *out++ = 0u; // sRGB
+
+    Pixel index[64]{};
+    Pixel previous{ 0xff000000u };
+    u32 run{ 0u };
+
+    for (std::size_t i{ 0u }; i < pixels.size(); ++i)
+    {
+        const Pixel p{ pixels[i] | 0xff000000u };
+        if (p == previous)
+        {
+            if (++run == 62u || i + 1u == pixels.size())
+            {
+                *out++ = static_cast<u8>(op_run | (run - 1u));
+                run = 0u;
+            }
+            continue;
+        }
+
+        if (run)
+        {
+            *out++ = static_cast<u8>(op_run | (run - 1u));
+            run = 0u;
+        }
+
+        const u32 r{ (p >> 16u) & 0xffu };
+        const u32 g{ (p >> 8u) & 0xffu };
+        const u32 b{ p & 0xffu };
+        const u32 hash{ (r * 3u + g * 5u + b * 7u + 255u * 11u) % 64u };
+
+        if (index[hash] == p)
+            *out++ = static_cast<u8>(op_index | hash);
+        else
+        {
+            index[hash] = p;
+
+            const i32 dr{ static_cast<i32>(r) - static_cast<i32>((previous >> 16u) & 0xffu) };
+            const i32 dg{ static_cast<i32>(g) - static_cast<i32>((previous >> 8u) & 0xffu) };
+            const i32 db{ static_cast<i32>(b) - static_cast<i32>(previous & 0xffu) };
+            // Channel differences wrap around in QOI, as they do in 8-bit arithmetic.
+            const i32 wr{ static_cast<i8>(dr) };
+            const i32 wg{ static_cast<i8>(dg) };
+            const i32 wb{ static_cast<i8>(db) };
+            const i32 dr_dg{ static_cast<i8>(wr - wg) };
+            const i32 db_dg{ static_cast<i8>(wb - wg) };
+
+            if (wr >= -2 && wr <= 1 && wg >= -2 && wg <= 1 && wb >= -2 && wb <= 1)
+                *out++ = static_cast<u8>(op_diff | (wr + 2) << 4 | (wg + 2) << 2 | (wb + 2));
+            else if (wg >= -32 && wg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+            {
+                *out++ = static_cast<u8>(op_luma | (wg + 32));
+                *out++ = static_cast<u8>((dr_dg + 8) << 4 | (db_dg + 8));
+            }
+            else
+            {
+                *out++ = op_rgb;
+                *out++ = static_cast<u8>(r);
+                *out++ = static_cast<u8>(g);
+                *out++ = static_cast<u8>(b);
+            }
+        }
+        previous = p;
+    }
+
+    constexpr u8 end_marker[]{ 0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u };
+    return std::copy(std::begin(end_marker), std::end(end_marker), out);
+}
+
+FrameCapture::FrameCapture(const CaptureSettings& settings, Size frame_size, ThreadPool& pool)
+    : m_settings(settings), m_frame_size(frame_size), m_pool(pool), m_encode_on_writer(!pool.get_thread_count()),
+      m_file(settings.path, settings.direct_io), m_writer(AsyncWriter::create(pool, s_chunk_count)),
+      m_last_revision(0u), m_has_frame(false), m_size_warned(false), m_mutex(), m_frame_ready(), m_space_free(),
+      m_frames(), m_free_frames(), m_pending(), m_pending_head(0u), m_pending_count(0u), m_stats(), m_stopping(false),
+      m_chunks(), m_chunk(0u), m_chunk_fill(0u), m_file_offset(0u), m_last_encoded(), m_last_size(0u),
+      m_completions(), m_failed(false), m_write_thread()
+{
+    if (!frame_size.w || !frame_size.h)
+        throw CaptureError("Cannot capture an empty surface.");
+
+    // Everything the frame loop will touch is allocated here, so submit() never allocates; only handing an encode
+    // task to the pool may.
+    const u32 frame_count{ std::max(settings.buffer_count, 1u) };
+    m_pending.resize(frame_count * 2u);
+    m_frames.resize(frame_count);
+    for (u32 i{ 0u }; i < frame_count; ++i)
+    {
+        m_frames[i].pixels.resize(static_cast<std::size_t>(frame_size.w) * frame_size.h);
+        m_frames[i].encoded.resize(get_max_encoded_size(frame_size));
+        m_frames[i].encoded_size = 0u;
+        m_frames[i].ready = false;
+        m_free_frames.push_back(i);
+    }
+    m_last_encoded.resize(get_max_encoded_size(frame_size));
+
+    for (u32 i{ 0u }; i < s_chunk_count; ++i)
+        m_chunks.push_back({ static_cast<u8*>(Memory::allocate(s_chunk_size, OutputFile::s_direct_alignment,
+                                                                   MemoryTag::Capture)),
+                             false });
+
+    SURREAL_LOG_INFO("Capturing {}x{} {} to {} ({} I/O through {}).", frame_size.w, frame_size.h,
+                     to_string(settings.format), settings.path, m_file.is_direct() ? "direct" : "buffered",
+                     m_writer->get_name());
+
+    m_write_thread = std::thread([this] {
+        AffinityPlan::apply_current(ThreadRole::Io);
+        write_loop();
+    });
+}
+
+FrameCapture::~FrameCapture()
+{
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_stopping = true;
+    }
+    m_frame_ready.notify_one();
+    m_write_thread.join();
+
+    // Destroying the writer waits for, or cancels, whatever the writer thread could not reap before the chunks go.
+    m_writer.reset();
+    for (const Chunk& chunk : m_chunks)
+        Memory::deallocate(chunk.data, s_chunk_size, OutputFile::s_direct_alignment, MemoryTag::Capture);
+
+    SURREAL_LOG_INFO("Capture to {} finished: {} frames written ({} repeated, {} dropped), {} bytes.", m_settings.path,
+                     m_stats.written, m_stats.repeated, m_stats.dropped, m_stats.bytes_written);
+}
+
+bool FrameCapture::submit(Surface& surface)
+{
+    const Size size{ surface.get_size() };
+    if (size.w != m_frame_size.w || size.h != m_frame_size.h) SURREAL_UNLIKELY
+    {
+        if (!m_size_warned)
+            SURREAL_LOG_WARN("Capture to {} is {}x{} but the surface is {}x{}; dropping frames until it matches.",
+                             m_settings.path, m_frame_size.w, m_frame_size.h, size.w, size.h);
+        m_size_warned = true;
+
+        std::scoped_lock lock{ m_mutex };
+        ++m_stats.submitted;
+        ++m_stats.dropped;
+        return false;
+    }
+
+    // A stale surface still holds the buffer an earlier submit() traded it, so the last frame stands, and there is
+    // none yet if that was another capture's submit().
+    const bool changed{ !surface.needs_redraw() && (!m_has_frame || surface.get_revision() != m_last_revision) };
+    u32 index{ s_repeat };
+    {
+        std::unique_lock lock{ m_mutex };
+        ++m_stats.submitted;
+
+        if (!changed && !m_has_frame) SURREAL_UNLIKELY
+        {
+            ++m_stats.dropped;
+            return false;
+        }
+
+        // A repeat only needs a pending slot; a changed frame also needs a buffer to swap into.
+        const auto has_room{ [this, changed] {
+            return m_pending_count < m_pending.size() && (!changed || !m_free_frames.empty());
+        } };
+        if (!has_room())
+        {
+            if (m_settings.overflow == CaptureOverflow::Drop)
+            {
+                ++m_stats.dropped;
+                return false;
+            }
+            m_space_free.wait(lock, has_room);
+        }
+
+        if (changed)
+        {
+            index = m_free_frames.back();
+            m_free_frames.pop_back();
+            m_frames[index].ready = false;
+        }
+        else
+            ++m_stats.repeated;
+        push_pending(index);
+
+        if (!changed)
+        {
+            m_frame_ready.notify_one();
+            return true;
+        }
+    }
+
+    // The frame is ours until the writer hands it back, so the swap needs no lock.
+    surface.swap_pixels(m_frames[index].pixels);
+    m_last_revision = surface.get_revision();
+    m_has_frame = true;
+
+    // Without workers the pool would encode right here on the frame loop, so leave it to the writer thread instead.
+    if (m_encode_on_writer)
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_frames[index].ready = true;
+        m_frame_ready.notify_one();
+        return true;
+    }
+
+    m_pool.submit([this, index] {
+        Frame& frame{ m_frames[index] };
+        encode(frame);
+
+        // Notified under the lock: the destructor may return as soon as the writer has seen the last frame.
+        std::scoped_lock lock{ m_mutex };
+        frame.ready = true;
+        m_frame_ready.notify_one();
+    });
+    return true;
+}
+
+CaptureStats FrameCapture::get_stats() const
+{
+    std::scoped_lock lock{ m_mutex };
+    return m_stats;
+}
+
+// Both expect m_mutex to be held.
+void FrameCapture::push_pending(u32 index) noexcept
+{
+    m_pending[(m_pending_head + m_pending_count) % m_pending.size()] = index;
+    ++m_pending_count;
+}
+
+u32 FrameCapture::pop_pending() noexcept
+{
+    const u32 index{ m_pending[m_pending_head] };
+    m_pending_head = (m_pending_head + 1u) % static_cast<u32>(m_pending.size());
+    --m_pending_count;
+    return index;
+}
+
+void FrameCapture::encode(Frame& frame) const
+{
+    const std::span<const Pixel> pixels{ frame.pixels };
+    u8* begin{ frame.encoded.data() };
+    u8* end{ begin };
+
+    switch (m_settings.format)
+    {
+    case CaptureFormat::Raw:
+        end = encode_raw(pixels, begin);
+        break;
+    case CaptureFormat::Y4m:
+        end = encode_y4m(pixels, m_frame_size, begin);
+        break;
+    case CaptureFormat::Qoi:
+        end = encode_qoi(pixels, m_frame_size, begin);
+        break;
+    }
+    frame.encoded_size = static_cast<std::size_t>(end - begin);
+}
+
+void FrameCapture::write_loop()
+{
+    if (m_settings.format == CaptureFormat::Y4m)
+    {
+        const std::string header{ fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n", m_frame_size.w,
+                                              m_frame_size.h, std::max(m_settings.frame_rate, 1u)) };
+        append({ reinterpret_cast<const u8*>(header.data()), header.size() });
+    }
+
+    while (true)
+    {
+        u32 index{ 0u };
+        {
+            // Frames are written in submission order, so one encoded ahead of its predecessors waits for them.
+            std::unique_lock lock{ m_mutex };
+            m_frame_ready.wait(lock, [this] {
+                if (!m_pending_count)
+                    return m_stopping;
+                const u32 front{ m_pending[m_pending_head] };
+                return front == s_repeat || m_frames[front].ready;
+            });
+            if (!m_pending_count)
+                break;
+
+            index = pop_pending();
+            m_space_free.notify_one();
+        }
+
+        if (index != s_repeat)
+        {
+            Frame& frame{ m_frames[index] };
+            if (m_encode_on_writer)
+                encode(frame);
+            append({ frame.encoded.data(), frame.encoded_size });
+
+            // Keep the bytes for repeats by trading buffers with the frame rather than copying them.
+            m_last_encoded.swap(frame.encoded);
+            m_last_size = frame.encoded_size;
+        }
+        else
+            append({ m_last_encoded.data(), m_last_size });
+
+        std::scoped_lock lock{ m_mutex };
+        ++m_stats.written;
+        m_stats.bytes_written += m_last_size;
+        if (index != s_repeat)
+        {
+            m_free_frames.push_back(index);
+            m_space_free.notify_one();
+        }
+    }
+
+    finish_file();
+}
+
+void FrameCapture::append(std::span<const u8> bytes)
+{
+    while (!bytes.empty() && !m_failed)
+    {
+        const std::size_t count{ std::min(bytes.size(), s_chunk_size - m_chunk_fill) };
+        std::memcpy(m_chunks[m_chunk].data + m_chunk_fill, bytes.data(), count);
+        m_chunk_fill += count;
+        bytes = bytes.subspan(count);
+
+        if (m_chunk_fill == s_chunk_size)
+            flush_chunk();
+    }
+}
+
+// Writes the current chunk and moves on to the next, waiting for the disk if that one is still being written.
+void FrameCapture::flush_chunk()
+{
+    Chunk& chunk{ m_chunks[m_chunk] };
+    std::size_t size{ m_chunk_fill };
+    if (m_file.is_direct())
+    {
+        size = align_up(size, OutputFile::s_direct_alignment);
+        std::memset(chunk.data + m_chunk_fill, 0, size - m_chunk_fill);
+    }
+
+    try
+    {
+        m_writer->write(m_file.get_handle(), m_file_offset, { chunk.data, size }, m_chunk);
+        chunk.busy = true;
+    }
+    catch (const FileError& e)
+    {
+        SURREAL_LOG_ERROR("Capture to {} failed: {}", m_settings.path, e.what());
+        m_failed = true;
+    }
+    m_file_offset += m_chunk_fill;
+
+    m_chunk = (m_chunk + 1u) % s_chunk_count;
+    m_chunk_fill = 0u;
+    while (m_chunks[m_chunk].busy && !m_failed)
+        reap();
+}
+
+// Returns false once the writer cannot report completions any more.
+bool FrameCapture::reap()
+{
+    m_completions.clear();
+    try
+    {
+        m_writer->wait(m_completions);
+    }
+    catch (const FileError& e)
+    {
+        if (!m_failed)
+            SURREAL_LOG_ERROR("Capture to {} failed: {}", m_settings.path, e.what());
+        m_failed = true;
+        return false;
+    }
+
+    for (const IoCompletion& completion : m_completions)
+    {
+        m_chunks[completion.user].busy = false;
+        if (completion.error && !m_failed)
+        {
+            SURREAL_LOG_ERROR("Capture to {} failed: {}", m_settings.path, std::strerror(completion.error));
+            m_failed = true;
+        }
+    }
+    return true;
+}
+
+void FrameCapture::finish_file()
+{
+    // Only the last chunk can be partial; with direct I/O it went out padded, and the padding is cut off again.
+    const u64 size{ m_file_offset + m_chunk_fill };
+    if (m_chunk_fill && !m_failed)
+        flush_chunk();
+
+    // Even after a failure: the chunks are freed once the capture is destroyed, and the writes still in flight read
+    // them.
+    bool reaping{ true };
+    while (reaping && std::any_of(m_chunks.begin(), m_chunks.end(), [](const Chunk& chunk) { return chunk.busy; }))
+        reaping = reap();
+
+    if (m_failed || !m_file.is_direct())
+        return;
+    try
+    {
+        m_file.truncate(size);
+    }
+    catch (const FileError& e)
+    {
+        SURREAL_LOG_ERROR("Capture to {} failed: {}", m_settings.path, e.what());
+    }
+}
+
+} // namespace Surreal
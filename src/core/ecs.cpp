@@ -0,0 +1,370 @@
+#include <core/ecs.hpp>
+#include <core/memory.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+#include <fmt/format.h>
+
+namespace Surreal
+{
+
+static constexpr std::size_t s_cache_line{ 64u };
+
+static constexpr std::size_t align_up(std::size_t value, std::size_t alignment) noexcept
+{
+    return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+namespace
+{
+
+struct ComponentRegistry
+{
+    std::mutex mutex;
+    std::array<ComponentInfo, ComponentMask::s_max_components> infos;
+    u32 count{ 0u };
+};
+
+ComponentRegistry& get_registry()
+{
+    static ComponentRegistry s_registry;
+    return s_registry;
+}
+
+} // namespace
+
+ComponentId Detail::register_component(const ComponentInfo& info)
+{
+    auto& registry{ get_registry() };
+    std::scoped_lock lock{ registry.mutex };
+
+    if (registry.count >= ComponentMask::s_max_components)
+        throw EcsError(fmt::format("Too many component types (limit is {}).", ComponentMask::s_max_components));
+    if (info.alignment > s_cache_line)
+        throw EcsError("Component alignment exceeds the cache line size.");
+
+    registry.infos[registry.count] = info;
+    return registry.count++;
+}
+
+// Infos are never modified after registration, so reading them needs no lock.
+const ComponentInfo& get_component_info(ComponentId id)
+{
+    return get_registry().infos[id];
+}
+
+Archetype::Archetype(const ComponentMask& mask, std::vector<ComponentId> ids)
+    : m_add_edges(), m_remove_edges(), m_mask(mask), m_ids(std::move(ids)), m_sizes(), m_offsets(), m_columns(),
+      m_chunks(), m_capacity(0u), m_size(0u)
+{
+    m_columns.fill(s_no_column);
+
+    std::size_t row_bytes{ sizeof(Entity) };
+    for (std::size_t i{ 0u }; i < m_ids.size(); ++i)
+    {
+        m_columns[m_ids[i]] = static_cast<u16>(i);
+        m_sizes.push_back(get_component_info(m_ids[i]).size);
+        row_bytes += m_sizes.back();
+    }
+
+    // Every array starts on its own cache line, which costs at most one line of padding each.
+    const std::size_t padding{ s_cache_line * (m_ids.size() + 1u) };
+    const std::size_t capacity{ s_chunk_bytes > padding ? (s_chunk_bytes - padding) / row_bytes : 0u };
+    if (!capacity)
+        throw EcsError("Archetype row does not fit in a chunk.");
+    m_capacity = static_cast<u32>(capacity);
+
+    std::size_t offset{ align_up(sizeof(Entity) * m_capacity, s_cache_line) };
+    for (u32 size : m_sizes)
+    {
+        m_offsets.push_back(static_cast<u32>(offset));
+        offset = align_up(offset + static_cast<std::size_t>(size) * m_capacity, s_cache_line);
+    }
+}
+
+Archetype::~Archetype()
+{
+    for (u32 row{ 0u }; row < m_size; ++row)
+        for (u16 column{ 0u }; column < m_ids.size(); ++column)
+            get_component_info(m_ids[column]).destroy(get_component(row, column));
+
+    for (u8* chunk : m_chunks)
+        Memory::deallocate(chunk, s_chunk_bytes, s_cache_line, MemoryTag::Core);
+}
+
+u32 Archetype::allocate_row(Entity entity)
+{
+    if (m_size == m_capacity * m_chunks.size())
+        m_chunks.push_back(static_cast<u8*>(Memory::allocate(s_chunk_bytes, s_cache_line, MemoryTag::Core)));
+
+    const u32 row{ m_size++ };
+    get_entities(row / m_capacity)[row % m_capacity] = entity;
+    return row;
+}
+
+Entity Archetype::remove_row(u32 row)
+{
+    const u32 last{ --m_size };
+    Entity moved{ s_null_entity };
+
+    if (row != last)
+    {
+        for (u16 column{ 0u }; column < m_ids.size(); ++column)
+            get_component_info(m_ids[column]).relocate(get_component(row, column), get_component(last, column));
+
+        moved = get_entity(last);
+        get_entities(row / m_capacity)[row % m_capacity] = moved;
+    }
+
+    // Keep one spare chunk around so an entity bouncing across a chunk boundary does not thrash the allocator.
+    if (m_chunks.size() > 1u && m_size + 2u * m_capacity <= m_capacity * m_chunks.size())
+    {
+        Memory::deallocate(m_chunks.back(), s_chunk_bytes, s_cache_line, MemoryTag::Core);
+        m_chunks.pop_back();
+    }
+
+    return moved;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+    clear();
+}
+
+void CommandBuffer::clear() noexcept
+{
+    for (auto& payload : m_payloads)
+        if (payload.data)
+            get_component_info(payload.id).destroy(payload.data);
+
+    m_commands.clear();
+    m_payloads.clear();
+    m_blocks_in_use = 0u;
+    m_block_used = s_block_size;
+}
+
+void* CommandBuffer::allocate(std::size_t size, std::size_t alignment)
+{
+    if (size > s_block_size)
+        throw EcsError("Component is too large for a command buffer.");
+
+    std::size_t offset{ align_up(m_block_used, alignment) };
+    if (offset + size > s_block_size)
+    {
+        // Blocks are kept across clear() and reused in order.
+        if (m_blocks_in_use == m_blocks.size())
+            m_blocks.emplace_back(new Block);
+        ++m_blocks_in_use;
+        offset = 0u;
+    }
+
+    m_block_used = offset + size;
+    return m_blocks[m_blocks_in_use - 1u]->bytes + offset;
+}
+
+World::World() : m_records(), m_free_indices(), m_entity_count(0u), m_archetypes(), m_archetype_lookup()
+{
+    // The empty archetype holds entities whose last component was removed.
+    get_archetype(ComponentMask());
+}
+
+World::~World() = default;
+
+const World::EntityRecord& World::get_record(Entity entity) const
+{
+    if (!is_alive(entity))
+        throw EcsError(fmt::format("Entity {}:{} is not alive.", entity.index, entity.generation));
+    return m_records[entity.index];
+}
+
+Entity World::allocate_entity()
+{
+    ++m_entity_count;
+
+    if (!m_free_indices.empty())
+    {
+        const u32 index{ m_free_indices.back() };
+        m_free_indices.pop_back();
+        return { index, m_records[index].generation };
+    }
+
+    m_records.push_back({ nullptr, 0u, 0u });
+    return { static_cast<u32>(m_records.size() - 1u), 0u };
+}
+
+void World::destroy(Entity entity)
+{
+    const auto& record{ get_record(entity) };
+    Archetype* archetype{ record.archetype };
+    const u32 row{ record.row };
+
+    for (u16 column{ 0u }; column < archetype->get_ids().size(); ++column)
+        get_component_info(archetype->get_ids()[column]).destroy(archetype->get_component(row, column));
+
+    const Entity moved{ archetype->remove_row(row) };
+    if (moved != s_null_entity)
+        m_records[moved.index].row = row;
+
+    auto& dead{ m_records[entity.index] };
+    dead.archetype = nullptr;
+    ++dead.generation;
+    m_free_indices.push_back(entity.index);
+    --m_entity_count;
+}
+
+Archetype* World::get_archetype(const ComponentMask& mask)
+{
+    auto it{ m_archetype_lookup.find(mask) };
+    if (it != m_archetype_lookup.end())
+        return it->second;
+
+    std::vector<ComponentId> ids;
+    for (ComponentId id{ 0u }; id < ComponentMask::s_max_components; ++id)
+        if (mask.test(id))
+            ids.push_back(id);
+
+    m_archetypes.push_back(std::make_unique<Archetype>(mask, std::move(ids)));
+    Archetype* archetype{ m_archetypes.back().get() };
+    m_archetype_lookup.emplace(mask, archetype);
+    return archetype;
+}
+
+Archetype* World::get_add_target(Archetype* source, ComponentId id)
+{
+    auto it{ source->m_add_edges.find(id) };
+    if (it != source->m_add_edges.end())
+        return it->second;
+
+    ComponentMask mask{ source->get_mask() };
+    mask.set(id);
+    Archetype* target{ get_archetype(mask) };
+    source->m_add_edges.emplace(id, target);
+    return target;
+}
+
+Archetype* World::get_remove_target(Archetype* source, ComponentId id)
+{
+    auto it{ source->m_remove_edges.find(id) };
+    if (it != source->m_remove_edges.end())
+        return it->second;
+
+    ComponentMask mask{ source->get_mask() };
+    mask.reset(id);
+    Archetype* target{ get_archetype(mask) };
+    source->m_remove_edges.emplace(id, target);
+    return target;
+}
+
+void World::move_entity(Entity entity, Archetype* target)
+{
+    auto& record{ m_records[entity.index] };
+    Archetype* source{ record.archetype };
+    const u32 source_row{ record.row };
+    const u32 target_row{ target->allocate_row(entity) };
+
+    for (u16 column{ 0u }; column < source->get_ids().size(); ++column)
+    {
+        const ComponentId id{ source->get_ids()[column] };
+        const u16 target_column{ target->get_column(id) };
+        const ComponentInfo& info{ get_component_info(id) };
+
+        if (target_column == Archetype::s_no_column)
+            info.destroy(source->get_component(source_row, column));
+        else
+            info.relocate(target->get_component(target_row, target_column), source->get_component(source_row, column));
+    }
+
+    const Entity moved{ source->remove_row(source_row) };
+    if (moved != s_null_entity)
+        m_records[moved.index].row = source_row;
+
+    record.archetype = target;
+    record.row = target_row;
+}
+
+void* World::add_uninitialized(Entity entity, ComponentId id)
+{
+    Archetype* target{ get_add_target(get_record(entity).archetype, id) };
+    move_entity(entity, target);
+
+    const auto& record{ m_records[entity.index] };
+    return target->get_component(record.row, target->get_column(id));
+}
+
+void World::remove(Entity entity, ComponentId id)
+{
+    Archetype* source{ get_record(entity).archetype };
+    if (!source->get_mask().test(id))
+        return;
+
+    move_entity(entity, get_remove_target(source, id));
+}
+
+void World::create(std::span<CommandBuffer::Payload> payloads)
+{
+    ComponentMask mask;
+    for (const auto& payload : payloads)
+        mask.set(payload.id);
+
+    Archetype* archetype{ get_archetype(mask) };
+    const Entity entity{ allocate_entity() };
+    const u32 row{ archetype->allocate_row(entity) };
+    m_records[entity.index].archetype = archetype;
+    m_records[entity.index].row = row;
+
+    for (auto& payload : payloads)
+    {
+        get_component_info(payload.id).relocate(archetype->get_component(row, archetype->get_column(payload.id)),
+                                                payload.data);
+        payload.data = nullptr;
+    }
+}
+
+void World::flush(CommandBuffer& commands)
+{
+    for (const auto& command : commands.m_commands)
+    {
+        std::span<CommandBuffer::Payload> payloads{ commands.m_payloads.data() + command.first_payload,
+                                                    command.payload_count };
+
+        switch (command.op)
+        {
+        case CommandBuffer::Op::Create:
+            create(payloads);
+            break;
+        case CommandBuffer::Op::Destroy:
+            if (is_alive(command.entity))
+                destroy(command.entity);
+            break;
+        case CommandBuffer::Op::Add:
+            if (is_alive(command.entity))
+            {
+                auto& payload{ payloads[0] };
+                const auto& record{ m_records[command.entity.index] };
+                const u16 column{ record.archetype->get_column(payload.id) };
+                const ComponentInfo& info{ get_component_info(payload.id) };
+
+                if (column != Archetype::s_no_column)
+                {
+                    void* existing{ record.archetype->get_component(record.row, column) };
+                    info.destroy(existing);
+                    info.relocate(existing, payload.data);
+                }
+                else
+                    info.relocate(add_uninitialized(command.entity, payload.id), payload.data);
+
+                payload.data = nullptr;
+            }
+            break;
+        case CommandBuffer::Op::Remove:
+            if (is_alive(command.entity))
+                remove(command.entity, commands.m_payloads[command.first_payload].id);
+            break;
+        }
+    }
+
+    commands.clear();
+}
+
+} // namespace Surreal
@@ -0,0 +1,280 @@
+#include <core/hit_test.hpp>
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace Surreal
+{
+
+static constexpr bool contains(const Rect& rect, Position pos) noexcept
+{
+    return pos.x >= rect.pos.x && pos.x - rect.pos.x < rect.size.w && pos.y >= rect.pos.y &&
+           pos.y - rect.pos.y < rect.size.h;
+}
+
+static constexpr u32 get_button_bit(MouseButton button) noexcept
+{
+    return 1u << static_cast<u32>(button);
+}
+
+HitRegions::HitRegions(Size bounds, u32 cell_size)
+    : m_records(), m_free_indices(), m_cells(), m_bounds(), m_cell_size(std::max(cell_size, 1u)), m_columns(0u),
+      m_rows(0u), m_sequence(0u), m_region_count(0u), m_capture(s_null_region), m_captured_buttons(0u)
+{
+    set_bounds(bounds);
+}
+
+HitRegion HitRegions::add(EventHandler* owner, Rect rect, i32 layer)
+{
+    if (!owner)
+        throw HitTestError("Hit regions need an owner.");
+
+    u32 index{ 0u };
+    if (!m_free_indices.empty())
+    {
+        index = m_free_indices.back();
+        m_free_indices.pop_back();
+    }
+    else
+    {
+        index = static_cast<u32>(m_records.size());
+        m_records.push_back({ {}, nullptr, 0, 0u, 0u, false, false });
+    }
+
+    Record& record{ m_records[index] };
+    record.rect = rect;
+    record.owner = owner;
+    record.layer = layer;
+    record.sequence = m_sequence++;
+    record.alive = true;
+    record.enabled = true;
+    ++m_region_count;
+
+    insert(index, get_cells(rect), {});
+    return { index, record.generation };
+}
+
+void HitRegions::remove(HitRegion region)
+{
+    Record& record{ get_record(region) };
+    erase(region.index, get_cells(record.rect), {});
+
+    record.owner = nullptr;
+    record.alive = false;
+    ++record.generation;
+    m_free_indices.push_back(region.index);
+    --m_region_count;
+}
+
+void HitRegions::clear()
+{
+    for (auto& cell : m_cells)
+        cell.clear();
+
+    // Records are kept so handles from before the clear stay stale instead of aliasing new regions.
+    for (u32 index{ 0u }; index < m_records.size(); ++index)
+    {
+        Record& record{ m_records[index] };
+        if (!record.alive)
+            continue;
+
+        record.owner = nullptr;
+        record.alive = false;
+        ++record.generation;
+        m_free_indices.push_back(index);
+    }
+    m_region_count = 0u;
+    m_capture = s_null_region;
+    m_captured_buttons = 0u;
+}
+
+void HitRegions::set_rect(HitRegion region, Rect rect)
+{
+    Record& record{ get_record(region) };
+    const CellRange old_cells{ get_cells(record.rect) };
+    const CellRange new_cells{ get_cells(rect) };
+    record.rect = rect;
+
+    // Only the cells the region leaves or enters change; a move within its cells costs nothing.
+    erase(region.index, old_cells, new_cells);
+    insert(region.index, new_cells, old_cells);
+}
+
+void HitRegions::set_layer(HitRegion region, i32 layer)
+{
+    Record& record{ get_record(region) };
+    if (record.layer == layer)
+        return;
+
+    const CellRange cells{ get_cells(record.rect) };
+    erase(region.index, cells, {});
+    record.layer = layer;
+    record.sequence = m_sequence++;
+    insert(region.index, cells, {});
+}
+
+void HitRegions::raise(HitRegion region)
+{
+    Record& record{ get_record(region) };
+    const CellRange cells{ get_cells(record.rect) };
+    erase(region.index, cells, {});
+    record.sequence = m_sequence++;
+    insert(region.index, cells, {});
+}
+
+void HitRegions::set_enabled(HitRegion region, bool enabled)
+{
+    get_record(region).enabled = enabled;
+}
+
+bool HitRegions::is_alive(HitRegion region) const noexcept
+{
+    return region.index < m_records.size() && m_records[region.index].alive &&
+           m_records[region.index].generation == region.generation;
+}
+
+Rect HitRegions::get_rect(HitRegion region) const
+{
+    return get_record(region).rect;
+}
+
+EventHandler* HitRegions::get_owner(HitRegion region) const
+{
+    return get_record(region).owner;
+}
+
+void HitRegions::set_bounds(Size bounds)
+{
+    m_bounds = bounds;
+    m_columns = (bounds.w + m_cell_size - 1u) / m_cell_size;
+    m_rows = (bounds.h + m_cell_size - 1u) / m_cell_size;
+
+    for (auto& cell : m_cells)
+        cell.clear();
+    m_cells.resize(static_cast<std::size_t>(m_columns) * m_rows);
+
+    // Adding in stacking order keeps every cell sorted with plain appends.
+    TaggedVector<u32, MemoryTag::Events> order;
+    order.reserve(m_region_count);
+    for (u32 index{ 0u }; index < m_records.size(); ++index)
+        if (m_records[index].alive)
+            order.push_back(index);
+    std::sort(order.begin(), order.end(), [this](u32 a, u32 b) { return is_above(a, b); });
+
+    for (u32 index : order)
+    {
+        const CellRange cells{ get_cells(m_records[index].rect) };
+        for (u32 y{ cells.y0 }; y < cells.y1; ++y)
+            for (u32 x{ cells.x0 }; x < cells.x1; ++x)
+                m_cells[static_cast<std::size_t>(y) * m_columns + x].push_back(index);
+    }
+}
+
+HitRegion HitRegions::hit_test(Position pos) const noexcept
+{
+    if (pos.x >= m_bounds.w || pos.y >= m_bounds.h)
+        return s_null_region;
+
+    const std::size_t cell{ static_cast<std::size_t>(pos.y / m_cell_size) * m_columns + pos.x / m_cell_size };
+    for (u32 index : m_cells[cell])
+    {
+        const Record& record{ m_records[index] };
+        if (record.enabled && contains(record.rect, pos))
+            return { index, record.generation };
+    }
+    return s_null_region;
+}
+
+bool HitRegions::route(MouseEvent& e, Position pos)
+{
+    const EventType type{ e.get_type() };
+    // Scrolling always goes to what is under the pointer.
+    const bool captured{ m_captured_buttons && is_alive(m_capture) };
+    const HitRegion target{ captured && type != EventType::MouseScroll ? m_capture : hit_test(pos) };
+
+    if (type == EventType::MouseButtonPress)
+    {
+        if (!captured)
+            m_capture = target;
+        m_captured_buttons |= get_button_bit(static_cast<MouseButtonEvent&>(e).get_button());
+    }
+    else if (type == EventType::MouseButtonRelease)
+    {
+        m_captured_buttons &= ~get_button_bit(static_cast<MouseButtonEvent&>(e).get_button());
+        if (!m_captured_buttons)
+            m_capture = s_null_region;
+    }
+
+    if (target == s_null_region)
+        return false;
+
+    e.set_region(target);
+    (*m_records[target.index].owner)(e);
+    return e.handled;
+}
+
+HitRegions::Record& HitRegions::get_record(HitRegion region)
+{
+    return const_cast<Record&>(static_cast<const HitRegions*>(this)->get_record(region));
+}
+
+const HitRegions::Record& HitRegions::get_record(HitRegion region) const
+{
+    if (!is_alive(region))
+        throw HitTestError(fmt::format("Hit region {}:{} is not alive.", region.index, region.generation));
+    return m_records[region.index];
+}
+
+HitRegions::CellRange HitRegions::get_cells(Rect rect) const noexcept
+{
+    if (!rect.size.w || !rect.size.h || rect.pos.x >= m_bounds.w || rect.pos.y >= m_bounds.h)
+        return {};
+
+    const u64 right{ std::min<u64>(u64{ rect.pos.x } + rect.size.w, m_bounds.w) };
+    const u64 bottom{ std::min<u64>(u64{ rect.pos.y } + rect.size.h, m_bounds.h) };
+    return { rect.pos.x / m_cell_size, rect.pos.y / m_cell_size,
+             static_cast<u32>((right + m_cell_size - 1u) / m_cell_size),
+             static_cast<u32>((bottom + m_cell_size - 1u) / m_cell_size) };
+}
+
+bool HitRegions::is_above(u32 a, u32 b) const noexcept
+{
+    const Record& ra{ m_records[a] };
+    const Record& rb{ m_records[b] };
+    return ra.layer != rb.layer ? ra.layer > rb.layer : ra.sequence > rb.sequence;
+}
+
+void HitRegions::insert(u32 index, CellRange range, CellRange skip)
+{
+    for (u32 y{ range.y0 }; y < range.y1; ++y)
+    {
+        for (u32 x{ range.x0 }; x < range.x1; ++x)
+        {
+            if (skip.contains(x, y))
+                continue;
+
+            auto& cell{ m_cells[static_cast<std::size_t>(y) * m_columns + x] };
+            cell.insert(std::upper_bound(cell.begin(), cell.end(), index,
+                                         [this](u32 a, u32 b) { return is_above(a, b); }),
+                        index);
+        }
+    }
+}
+
+void HitRegions::erase(u32 index, CellRange range, CellRange skip) noexcept
+{
+    for (u32 y{ range.y0 }; y < range.y1; ++y)
+    {
+        for (u32 x{ range.x0 }; x < range.x1; ++x)
+        {
+            if (skip.contains(x, y))
+                continue;
+
+            auto& cell{ m_cells[static_cast<std::size_t>(y) * m_columns + x] };
+            cell.erase(std::find(cell.begin(), cell.end(), index));
+        }
+    }
+}
+
+} // namespace Surreal
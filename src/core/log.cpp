@@ -0,0 +1,320 @@
+#include <core/log.hpp>
+#include <core/topology.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <cstring>
+
+namespace Surreal
+{
+
+namespace
+{
+
+class Logger
+{
+public:
+    static Logger& get()
+    {
+        static Logger s_logger;
+        return s_logger;
+    }
+
+    ~Logger() { stop(); }
+
+    void start()
+    {
+        std::scoped_lock lock{ m_thread_mutex };
+        if (m_thread.joinable())
+            return;
+
+        m_stop_requested = false;
+        m_thread = std::thread([this] {
+            AffinityPlan::apply_current(ThreadRole::Log);
+            run();
+        });
+    }
+
+    void stop()
+    {
+        std::scoped_lock lock{ m_thread_mutex };
+        if (m_thread.joinable())
+        {
+            {
+                std::scoped_lock wake_lock{ m_wake_mutex };
+                m_stop_requested = true;
+            }
+            m_wake.notify_one();
+            m_thread.join();
+        }
+
+        // Producers may have raced with the stop request, or the thread was never started.
+        fmt::memory_buffer line;
+        drain(line);
+    }
+
+    void add_sink(std::unique_ptr<LogSink> sink)
+    {
+        std::scoped_lock lock{ m_sink_mutex };
+        m_sinks.emplace_back(std::move(sink));
+    }
+
+    Detail::LogRing* register_ring()
+    {
+        auto ring{ std::make_unique<Detail::LogRing>() };
+        auto ptr{ ring.get() };
+
+        std::scoped_lock lock{ m_ring_mutex };
+        m_rings.emplace_back(std::move(ring));
+        return ptr;
+    }
+
+    u64 dropped_count() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    Logger() : m_epoch(std::chrono::steady_clock::now().time_since_epoch().count()) {}
+
+    void run()
+    {
+        fmt::memory_buffer line;
+        while (true)
+        {
+            const bool drained_any{ drain(line) };
+
+            std::unique_lock lock{ m_wake_mutex };
+            if (m_stop_requested)
+                break;
+
+            if (!drained_any)
+                m_wake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+
+    bool drain(fmt::memory_buffer& line)
+    {
+        bool drained_any{ false };
+
+        std::scoped_lock ring_lock{ m_ring_mutex };
+        std::scoped_lock sink_lock{ m_sink_mutex };
+
+        for (auto pring{ m_rings.begin() }; pring != m_rings.end();)
+        {
+            Detail::LogRing& ring{ **pring };
+            // Read before draining so a ring retired mid-pass is only freed once a later pass finds it empty.
+            const bool retired{ ring.retired() };
+
+            const Detail::LogRecord* record{ nullptr };
+            while ((record = ring.peek()))
+            {
+                line.clear();
+                fmt::format_to(std::back_inserter(line), "[{:>14.6f}] [{}] ",
+                               static_cast<f64>(record->timestamp - m_epoch) * 1e-9, to_string(record->level));
+                try
+                {
+                    record->formatter(record->payload, record->format, record->format_size, line);
+                }
+                catch (const fmt::format_error& e)
+                {
+                    // Formats are checked at compile time, but dynamic widths and precisions are not.
+                    fmt::format_to(std::back_inserter(line), "<bad log format \"{}\": {}>",
+                                   std::string_view(record->format, record->format_size), e.what());
+                }
+                line.push_back('\n');
+
+                emit(record->level, std::string_view(line.data(), line.size()));
+                ring.pop();
+                drained_any = true;
+            }
+
+            if (const u64 dropped{ ring.take_dropped() })
+            {
+                m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+                line.clear();
+                fmt::format_to(std::back_inserter(line), "[{:>14}] [warn] Log ring full, dropped {} record(s).\n", "",
+                               dropped);
+                emit(LogLevel::Warn, std::string_view(line.data(), line.size()));
+            }
+
+            if (retired)
+                pring = m_rings.erase(pring);
+            else
+                ++pring;
+        }
+
+        if (drained_any)
+        {
+            for (auto& sink : m_sinks)
+                sink->flush();
+            if (m_sinks.empty())
+                m_stderr_sink.flush();
+        }
+
+        return drained_any;
+    }
+
+    void emit(LogLevel level, std::string_view text)
+    {
+        if (m_sinks.empty())
+        {
+            m_stderr_sink.write(level, text);
+            return;
+        }
+
+        for (auto& sink : m_sinks)
+        {
+            try
+            {
+                sink->write(level, text);
+            }
+            catch (const Exception& e)
+            {
+                // There is nobody to report to on this thread, fall back to stderr rather than losing the line.
+                m_stderr_sink.write(LogLevel::Error, fmt::format("Log sink failed: {}\n", e.what()));
+                m_stderr_sink.write(level, text);
+            }
+        }
+    }
+
+    i64 m_epoch;
+
+    std::mutex m_thread_mutex;
+    std::thread m_thread;
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    bool m_stop_requested{ false };
+
+    std::mutex m_ring_mutex;
+    std::vector<std::unique_ptr<Detail::LogRing>> m_rings;
+
+    std::mutex m_sink_mutex;
+    std::vector<std::unique_ptr<LogSink>> m_sinks;
+    StderrLogSink m_stderr_sink;
+
+    std::atomic<u64> m_dropped{ 0u };
+};
+
+// Retires the thread's ring on thread exit; the logger frees it once drained.
+struct ThreadRingHandle
+{
+    Detail::LogRing* ring{ Logger::get().register_ring() };
+
+    ~ThreadRingHandle() { ring->retire(); }
+};
+
+} // namespace
+
+void StderrLogSink::write(SURREAL_UNUSED(LogLevel, level), std::string_view line)
+{
+    std::fwrite(line.data(), 1u, line.size(), stderr);
+}
+
+void StderrLogSink::flush()
+{
+    std::fflush(stderr);
+}
+
+FileLogSink::FileLogSink(const std::string& path, bool truncate) : m_path(path), m_file(nullptr), m_size(0u)
+{
+    open(truncate);
+}
+
+FileLogSink::~FileLogSink()
+{
+    close();
+}
+
+void FileLogSink::write(SURREAL_UNUSED(LogLevel, level), std::string_view line)
+{
+    // A failed rotation leaves the sink closed; retry on the next line.
+    if (!m_file) SURREAL_UNLIKELY
+        open(false);
+
+    m_size += std::fwrite(line.data(), 1u, line.size(), m_file);
+}
+
+void FileLogSink::flush()
+{
+    if (m_file)
+        std::fflush(m_file);
+}
+
+void FileLogSink::open(bool truncate)
+{
+    m_file = std::fopen(m_path.c_str(), truncate ? "w" : "a");
+    if (!m_file)
+        throw LogError(fmt::format("Failed to open log file {}: {}.", m_path, std::strerror(errno)));
+
+    std::fseek(m_file, 0, SEEK_END);
+    const long size{ std::ftell(m_file) };
+    m_size = size > 0 ? static_cast<u64>(size) : 0u;
+}
+
+void FileLogSink::close() noexcept
+{
+    if (m_file)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+RotatingFileLogSink::RotatingFileLogSink(const std::string& path, u64 max_bytes, u32 max_files)
+    : FileLogSink(path), m_max_bytes(max_bytes), m_max_files(max_files)
+{
+}
+
+void RotatingFileLogSink::write(LogLevel level, std::string_view line)
+{
+    if (m_size && m_size + line.size() > m_max_bytes)
+        rotate();
+
+    FileLogSink::write(level, line);
+}
+
+// path -> path.1 -> path.2 -> ... -> path.<max_files>, the oldest file falls off the end.
+void RotatingFileLogSink::rotate()
+{
+    close();
+
+    if (m_max_files)
+    {
+        std::remove(fmt::format("{}.{}", m_path, m_max_files).c_str());
+        for (u32 i{ m_max_files - 1u }; i > 0u; --i)
+            std::rename(fmt::format("{}.{}", m_path, i).c_str(), fmt::format("{}.{}", m_path, i + 1u).c_str());
+        std::rename(m_path.c_str(), fmt::format("{}.1", m_path).c_str());
+    }
+
+    open(true);
+}
+
+void Log::start()
+{
+    Logger::get().start();
+}
+
+void Log::stop()
+{
+    Logger::get().stop();
+}
+
+void Log::add_sink(std::unique_ptr<LogSink> sink)
+{
+    Logger::get().add_sink(std::move(sink));
+}
+
+u64 Log::dropped_count() noexcept
+{
+    return Logger::get().dropped_count();
+}
+
+Detail::LogRing& Log::thread_ring()
+{
+    static thread_local ThreadRingHandle s_handle;
+    return *s_handle.ring;
+}
+
+} // namespace Surreal
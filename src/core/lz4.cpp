@@ -0,0 +1,168 @@
+#include <core/lz4.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Surreal
+{
+
+namespace
+{
+
+constexpr std::size_t s_min_match{ 4u };
+// The format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end.
+constexpr std::size_t s_last_literals{ 5u };
+constexpr std::size_t s_match_limit{ 12u };
+constexpr std::size_t s_max_offset{ 65535u };
+constexpr u32 s_hash_bits{ 12u };
+
+u32 read32(const u8* p) noexcept
+{
+    u32 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+constexpr u32 hash(u32 sequence) noexcept { return (sequence * 2654435761u) >> (32u - s_hash_bits); }
+
+// Writes the 255-run continuation of a length whose nibble saturated at 15.
+u8* write_length(u8* op, std::size_t length) noexcept
+{
+    for (; length >= 255u; length -= 255u)
+        *op++ = 255u;
+    *op++ = static_cast<u8>(length);
+    return op;
+}
+
+} // namespace
+
+std::size_t lz4_compress(std::span<const u8> src, std::span<u8> dst) noexcept
+{
+    if (dst.size() < lz4_compress_bound(src.size()))
+        return 0u;
+
+    const u8* const base{ src.data() };
+    const std::size_t size{ src.size() };
+    u8* op{ dst.data() };
+
+    auto emit{ [&op, base](std::size_t anchor, std::size_t literals, std::size_t offset, std::size_t match) {
+        u8* token{ op++ };
+        *token = static_cast<u8>((literals < 15u ? literals : 15u) << 4u);
+        if (literals >= 15u)
+            op = write_length(op, literals - 15u);
+        if (literals)
+            std::memcpy(op, base + anchor, literals);
+        op += literals;
+
+        if (!match)
+            return;
+
+        *op++ = static_cast<u8>(offset);
+        *op++ = static_cast<u8>(offset >> 8u);
+        const std::size_t extra{ match - s_min_match };
+        *token |= static_cast<u8>(extra < 15u ? extra : 15u);
+        if (extra >= 15u)
+            op = write_length(op, extra - 15u);
+    } };
+
+    std::size_t anchor{ 0u };
+    if (size > s_match_limit)
+    {
+        std::array<u32, std::size_t(1) << s_hash_bits> table{};
+        const std::size_t match_end{ size - s_last_literals };
+
+        std::size_t ip{ 0u };
+        while (ip + s_match_limit <= size)
+        {
+            const u32 sequence{ read32(base + ip) };
+            const u32 slot{ hash(sequence) };
+            const std::size_t ref{ table[slot] };
+            table[slot] = static_cast<u32>(ip);
+
+            if (ref >= ip || ip - ref > s_max_offset || read32(base + ref) != sequence)
+            {
+                ++ip;
+                continue;
+            }
+
+            std::size_t length{ s_min_match };
+            while (ip + length < match_end && base[ref + length] == base[ip + length])
+                ++length;
+
+            emit(anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    emit(anchor, size - anchor, 0u, 0u);
+    return static_cast<std::size_t>(op - dst.data());
+}
+
+bool lz4_decompress(std::span<const u8> src, std::span<u8> dst) noexcept
+{
+    const u8* ip{ src.data() };
+    const u8* const ip_end{ ip + src.size() };
+    u8* op{ dst.data() };
+    u8* const op_end{ op + dst.size() };
+
+    auto read_length{ [&ip, ip_end](std::size_t& length) {
+        u8 byte;
+        do
+        {
+            if (ip == ip_end)
+                return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255u);
+        return true;
+    } };
+
+    while (ip < ip_end)
+    {
+        const u8 token{ *ip++ };
+
+        std::size_t literals{ static_cast<std::size_t>(token >> 4u) };
+        if (literals == 15u && !read_length(literals))
+            return false;
+        if (literals > static_cast<std::size_t>(ip_end - ip) || literals > static_cast<std::size_t>(op_end - op))
+            return false;
+        if (literals)
+            std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence has literals only.
+        if (ip == ip_end)
+            break;
+
+        if (ip_end - ip < 2)
+            return false;
+        const std::size_t offset{ static_cast<std::size_t>(ip[0]) | static_cast<std::size_t>(ip[1]) << 8u };
+        ip += 2;
+        if (!offset || offset > static_cast<std::size_t>(op - dst.data()))
+            return false;
+
+        std::size_t length{ static_cast<std::size_t>(token & 15u) };
+        if (length == 15u && !read_length(length))
+            return false;
+        length += s_min_match;
+        if (length > static_cast<std::size_t>(op_end - op))
+            return false;
+
+        // An overlapping match repeats its first offset bytes. Copying from the match start in steps no longer than
+        // the distance already written keeps every memcpy non-overlapping, and the step doubles each time.
+        const u8* match{ op - offset };
+        for (u8* const end{ op + length }; op < end;)
+        {
+            const auto step{ static_cast<std::size_t>(std::min(op - match, end - op)) };
+            std::memcpy(op, match, step);
+            op += step;
+        }
+    }
+
+    return op == op_end;
+}
+
+} // namespace Surreal
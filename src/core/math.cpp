@@ -0,0 +1,51 @@
+#include <core/math.hpp>
+
+#include <bit>
+
+namespace Surreal
+{
+
+void transform_points(const Mat4& m, std::span<const Vec3x8> points, std::span<Vec3x8> out) noexcept
+{
+    for (std::size_t i{ 0u }; i < points.size(); ++i)
+        out[i] = transform_point(m, points[i]);
+}
+
+namespace
+{
+
+template <typename BoundsTp>
+std::size_t cull_blocks(const Frustum& frustum, std::span<const BoundsTp> bounds, std::size_t count,
+                        std::span<u8> visible) noexcept
+{
+    std::size_t visible_count{ 0u };
+    for (std::size_t i{ 0u }; i < bounds.size(); ++i)
+    {
+        u32 mask{ test(frustum, bounds[i]) };
+        // Blocks wholly past count are masked out entirely.
+        const std::size_t first{ i * 8u };
+        const std::size_t remaining{ first >= count ? 0u : count - first };
+        if (remaining < 8u)
+            mask &= (1u << remaining) - 1u;
+
+        visible[i] = static_cast<u8>(mask);
+        visible_count += static_cast<std::size_t>(std::popcount(mask));
+    }
+    return visible_count;
+}
+
+} // namespace
+
+std::size_t cull(const Frustum& frustum, std::span<const AABBx8> boxes, std::size_t count,
+                 std::span<u8> visible) noexcept
+{
+    return cull_blocks(frustum, boxes, count, visible);
+}
+
+std::size_t cull(const Frustum& frustum, std::span<const Spherex8> spheres, std::size_t count,
+                 std::span<u8> visible) noexcept
+{
+    return cull_blocks(frustum, spheres, count, visible);
+}
+
+} // namespace Surreal
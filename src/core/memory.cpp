@@ -0,0 +1,446 @@
+#include <core/memory.hpp>
+
+#include <core/log.hpp>
+#include <core/topology.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Surreal
+{
+
+namespace
+{
+
+constexpr std::size_t s_tag_count{ static_cast<std::size_t>(MemoryTag::Count) };
+constexpr std::size_t s_class_count{ Memory::s_max_small_size / Memory::s_small_alignment };
+constexpr std::size_t s_slab_size{ 64u * 1024u };
+constexpr std::size_t s_page_size{ 4096u };
+// Nodes with their own central pools; higher node ids share them modulo this.
+constexpr u32 s_max_nodes{ 8u };
+constexpr u32 s_no_node{ ~0u };
+// Blocks a thread keeps per size class before handing half of them back.
+constexpr u32 s_cache_limit{ 256u };
+constexpr u32 s_refill_count{ 32u };
+
+struct Counters
+{
+    std::array<std::atomic<i64>, s_tag_count> bytes{};
+    std::array<std::atomic<i64>, s_tag_count> allocations{};
+    std::array<std::atomic<u64>, s_tag_count> total{};
+};
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+// One per size class and NUMA node, shared by the threads placed on that node. Threads move blocks in and out in
+// batches.
+struct CentralPool
+{
+    std::mutex mutex;
+    FreeBlock* head{ nullptr };
+    u32 count{ 0u };
+};
+
+struct ThreadCache
+{
+    std::array<FreeBlock*, s_class_count> heads;
+    std::array<u32, s_class_count> counts;
+};
+
+enum struct ThreadState : u8
+{
+    Uninitialized,
+    Active,
+    // Thread-local destructors have run. Later allocations on this thread skip the cache and count into the shared
+    // block.
+    Exited,
+};
+
+class Registry
+{
+public:
+    // Never destroyed: static destructors and late thread-local destructors may still free tracked memory.
+    static Registry& get()
+    {
+        static Registry* s_registry{ new Registry };
+        return *s_registry;
+    }
+
+    Counters* acquire_counters()
+    {
+        std::scoped_lock lock{ m_mutex };
+        if (!m_free_counters.empty())
+        {
+            Counters* counters{ m_free_counters.back() };
+            m_free_counters.pop_back();
+            return counters;
+        }
+        return m_counters.emplace_back(std::make_unique<Counters>()).get();
+    }
+
+    // Counts persist in the block, so the next thread to take it carries them on.
+    void release_counters(Counters* counters)
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_free_counters.push_back(counters);
+    }
+
+    Counters& get_shared_counters() noexcept { return m_shared; }
+
+    MemoryStats merge(MemoryTag tag) noexcept
+    {
+        const std::size_t i{ static_cast<std::size_t>(tag) };
+        MemoryStats stats{ m_shared.bytes[i].load(std::memory_order_relaxed),
+                           m_shared.allocations[i].load(std::memory_order_relaxed),
+                           m_shared.total[i].load(std::memory_order_relaxed), 0, 0u };
+        {
+            std::scoped_lock lock{ m_mutex };
+            for (const auto& counters : m_counters)
+            {
+                stats.live_bytes += counters->bytes[i].load(std::memory_order_relaxed);
+                stats.live_allocations += counters->allocations[i].load(std::memory_order_relaxed);
+                stats.total_allocations += counters->total[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        i64 peak{ m_peak[i].load(std::memory_order_relaxed) };
+        while (stats.live_bytes > peak &&
+               !m_peak[i].compare_exchange_weak(peak, stats.live_bytes, std::memory_order_relaxed))
+        {
+        }
+        stats.peak_bytes = std::max(peak, stats.live_bytes);
+        stats.budget = m_budgets[i].load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void set_budget(MemoryTag tag, u64 bytes) noexcept
+    {
+        m_budgets[static_cast<std::size_t>(tag)].store(bytes, std::memory_order_relaxed);
+    }
+
+    // Returns true the first time the tag is seen over budget since it was last under.
+    bool update_over_budget(MemoryTag tag, bool over) noexcept
+    {
+        std::atomic<bool>& flag{ m_over_budget[static_cast<std::size_t>(tag)] };
+        if (!over)
+        {
+            flag.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return !flag.exchange(true, std::memory_order_relaxed);
+    }
+
+    // Moves up to count blocks of the size class onto head, carving a new slab if the pool is empty.
+    u32 take_blocks(std::size_t size_class, u32 node, FreeBlock*& head, u32 count)
+    {
+        CentralPool& pool{ get_pool(size_class, node) };
+        std::scoped_lock lock{ pool.mutex };
+        if (!pool.head)
+            carve_slab(size_class, node, pool);
+
+        u32 taken{ 0u };
+        while (pool.head && taken < count)
+        {
+            FreeBlock* block{ pool.head };
+            pool.head = block->next;
+            block->next = head;
+            head = block;
+            ++taken;
+        }
+        pool.count -= taken;
+        return taken;
+    }
+
+    void give_blocks(std::size_t size_class, u32 node, FreeBlock* head, FreeBlock* tail, u32 count) noexcept
+    {
+        CentralPool& pool{ get_pool(size_class, node) };
+        std::scoped_lock lock{ pool.mutex };
+        tail->next = pool.head;
+        pool.head = head;
+        pool.count += count;
+    }
+
+    PoolStats get_pool_stats() const noexcept
+    {
+        return { m_slab_count.load(std::memory_order_relaxed) * s_slab_size,
+                 m_slab_count.load(std::memory_order_relaxed) };
+    }
+
+private:
+    Registry() = default;
+
+    CentralPool& get_pool(std::size_t size_class, u32 node) noexcept
+    {
+        return m_pools[node == s_no_node ? 0u : node % s_max_nodes][size_class];
+    }
+
+    // Slabs of a placed thread are bound to its node; carving them here also first-touches every page from it.
+    void carve_slab(std::size_t size_class, u32 node, CentralPool& pool)
+    {
+        const std::size_t block_size{ (size_class + 1u) * Memory::s_small_alignment };
+        u8* slab{ static_cast<u8*>(::operator new(s_slab_size, std::align_val_t{ s_page_size })) };
+        if (node != s_no_node)
+            bind_memory_to_node(slab, s_slab_size, node);
+        m_slab_count.fetch_add(1u, std::memory_order_relaxed);
+
+        const std::size_t block_count{ s_slab_size / block_size };
+        for (std::size_t i{ block_count }; i--;)
+        {
+            FreeBlock* block{ reinterpret_cast<FreeBlock*>(slab + i * block_size) };
+            block->next = pool.head;
+            pool.head = block;
+        }
+        pool.count += static_cast<u32>(block_count);
+    }
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Counters>> m_counters;
+    std::vector<Counters*> m_free_counters;
+    Counters m_shared;
+
+    std::array<std::atomic<i64>, s_tag_count> m_peak{};
+    std::array<std::atomic<u64>, s_tag_count> m_budgets{};
+    std::array<std::atomic<bool>, s_tag_count> m_over_budget{};
+
+    std::array<std::array<CentralPool, s_class_count>, s_max_nodes> m_pools;
+    std::atomic<u64> m_slab_count{ 0u };
+};
+
+constinit thread_local ThreadState t_state{ ThreadState::Uninitialized };
+constinit thread_local Counters* t_counters{ nullptr };
+constinit thread_local ThreadCache t_cache{};
+constinit thread_local u32 t_node{ s_no_node };
+
+// Hands every cached block back to the pools of the thread's current node.
+void flush_cache() noexcept
+{
+    Registry& registry{ Registry::get() };
+    for (std::size_t size_class{ 0u }; size_class < s_class_count; ++size_class)
+    {
+        FreeBlock* head{ t_cache.heads[size_class] };
+        if (!head)
+            continue;
+
+        FreeBlock* tail{ head };
+        while (tail->next)
+            tail = tail->next;
+        registry.give_blocks(size_class, t_node, head, tail, t_cache.counts[size_class]);
+        t_cache.heads[size_class] = nullptr;
+        t_cache.counts[size_class] = 0u;
+    }
+}
+
+struct ThreadExit
+{
+    ~ThreadExit()
+    {
+        Registry& registry{ Registry::get() };
+        flush_cache();
+
+        registry.release_counters(t_counters);
+        t_counters = nullptr;
+        t_state = ThreadState::Exited;
+    }
+};
+
+void start_thread()
+{
+    if (t_state != ThreadState::Uninitialized)
+        return;
+
+    t_counters = Registry::get().acquire_counters();
+    t_state = ThreadState::Active;
+    static thread_local ThreadExit s_exit;
+}
+
+SURREAL_ALWAYS_INLINE void add(std::atomic<i64>& counter, i64 value, bool shared) noexcept
+{
+    if (shared)
+        counter.fetch_add(value, std::memory_order_relaxed);
+    else
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+SURREAL_ALWAYS_INLINE void count(MemoryTag tag, i64 bytes, i64 allocations) noexcept
+{
+    const bool shared{ !t_counters };
+    Counters& counters{ shared ? Registry::get().get_shared_counters() : *t_counters };
+    const std::size_t i{ static_cast<std::size_t>(tag) };
+
+    add(counters.bytes[i], bytes, shared);
+    add(counters.allocations[i], allocations, shared);
+    if (allocations > 0)
+    {
+        if (shared)
+            counters.total[i].fetch_add(1u, std::memory_order_relaxed);
+        else
+            counters.total[i].store(counters.total[i].load(std::memory_order_relaxed) + 1u,
+                                    std::memory_order_relaxed);
+    }
+}
+
+constexpr bool is_small(std::size_t size, std::size_t alignment) noexcept
+{
+    return size <= Memory::s_max_small_size && alignment <= Memory::s_small_alignment;
+}
+
+constexpr std::size_t get_size_class(std::size_t size) noexcept
+{
+    return size ? (size - 1u) / Memory::s_small_alignment : 0u;
+}
+
+void* allocate_small(std::size_t size_class)
+{
+    Registry& registry{ Registry::get() };
+    if (t_state == ThreadState::Exited) SURREAL_UNLIKELY
+    {
+        FreeBlock* block{ nullptr };
+        registry.take_blocks(size_class, t_node, block, 1u);
+        return block;
+    }
+
+    FreeBlock*& head{ t_cache.heads[size_class] };
+    if (!head) SURREAL_UNLIKELY
+        t_cache.counts[size_class] = registry.take_blocks(size_class, t_node, head, s_refill_count);
+
+    FreeBlock* block{ head };
+    head = block->next;
+    --t_cache.counts[size_class];
+    return block;
+}
+
+void deallocate_small(void* ptr, std::size_t size_class) noexcept
+{
+    FreeBlock* block{ static_cast<FreeBlock*>(ptr) };
+    if (t_state == ThreadState::Exited) SURREAL_UNLIKELY
+    {
+        Registry::get().give_blocks(size_class, t_node, block, block, 1u);
+        return;
+    }
+
+    FreeBlock*& head{ t_cache.heads[size_class] };
+    block->next = head;
+    head = block;
+    if (++t_cache.counts[size_class] <= s_cache_limit) SURREAL_LIKELY
+        return;
+
+    // Keep the most recently freed half, which is the warmer one, and return the rest.
+    FreeBlock* tail{ head };
+    for (u32 i{ 1u }; i < s_cache_limit / 2u; ++i)
+        tail = tail->next;
+    FreeBlock* returned{ tail->next };
+    tail->next = nullptr;
+
+    FreeBlock* returned_tail{ returned };
+    while (returned_tail->next)
+        returned_tail = returned_tail->next;
+
+    const u32 returned_count{ t_cache.counts[size_class] - s_cache_limit / 2u };
+    t_cache.counts[size_class] = s_cache_limit / 2u;
+    Registry::get().give_blocks(size_class, t_node, returned, returned_tail, returned_count);
+}
+
+} // namespace
+
+void* Memory::allocate(std::size_t size, std::size_t alignment, MemoryTag tag)
+{
+    if (t_state == ThreadState::Uninitialized) SURREAL_UNLIKELY
+        start_thread();
+
+    void* ptr{ nullptr };
+    if (is_small(size, alignment))
+        ptr = allocate_small(get_size_class(size));
+    else if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        ptr = ::operator new(size, std::align_val_t{ alignment });
+    else
+        ptr = ::operator new(size);
+
+    count(tag, static_cast<i64>(size), 1);
+    return ptr;
+}
+
+void Memory::deallocate(void* ptr, std::size_t size, std::size_t alignment, MemoryTag tag) noexcept
+{
+    if (!ptr)
+        return;
+    if (t_state == ThreadState::Uninitialized) SURREAL_UNLIKELY
+        start_thread();
+
+    if (is_small(size, alignment))
+        deallocate_small(ptr, get_size_class(size));
+    else if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        ::operator delete(ptr, size, std::align_val_t{ alignment });
+    else
+        ::operator delete(ptr, size);
+
+    count(tag, -static_cast<i64>(size), -1);
+}
+
+MemoryStats Memory::get_stats(MemoryTag tag) noexcept
+{
+    return Registry::get().merge(tag);
+}
+
+PoolStats Memory::get_pool_stats() noexcept
+{
+    return Registry::get().get_pool_stats();
+}
+
+void Memory::set_budget(MemoryTag tag, u64 bytes) noexcept
+{
+    Registry::get().set_budget(tag, bytes);
+}
+
+u32 Memory::check_budgets() noexcept
+{
+    Registry& registry{ Registry::get() };
+    u32 over_count{ 0u };
+    for (std::size_t i{ 0u }; i < s_tag_count; ++i)
+    {
+        const MemoryTag tag{ static_cast<MemoryTag>(i) };
+        const MemoryStats stats{ registry.merge(tag) };
+        const bool over{ stats.budget && stats.live_bytes > static_cast<i64>(stats.budget) };
+        if (registry.update_over_budget(tag, over))
+            SURREAL_LOG_WARN("Memory tag '{}' is over budget: {} of {} bytes in {} allocations.", to_string(tag),
+                             stats.live_bytes, stats.budget, stats.live_allocations);
+        over_count += over;
+    }
+    return over_count;
+}
+
+void Memory::set_thread_node(u32 node) noexcept
+{
+    if (node == t_node)
+        return;
+
+    // Cached blocks came from the old node; leaving them in the cache would keep handing them out.
+    if (t_state == ThreadState::Active)
+        flush_cache();
+    t_node = node;
+}
+
+bool Memory::report_leaks() noexcept
+{
+    bool clean{ true };
+    for (std::size_t i{ 0u }; i < s_tag_count; ++i)
+    {
+        const MemoryTag tag{ static_cast<MemoryTag>(i) };
+        const MemoryStats stats{ Registry::get().merge(tag) };
+        if (!stats.live_allocations && !stats.live_bytes)
+            continue;
+
+        SURREAL_LOG_WARN("Memory tag '{}' leaked {} bytes in {} allocations (peak {} bytes).", to_string(tag),
+                         stats.live_bytes, stats.live_allocations, stats.peak_bytes);
+        clean = false;
+    }
+    return clean;
+}
+
+} // namespace Surreal
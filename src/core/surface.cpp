@@ -0,0 +1,34 @@
+#include <core/surface.hpp>
+
+#include <algorithm>
+
+namespace Surreal
+{
+
+void Surface::resize(Size size)
+{
+    m_size = size;
+    m_pixels.assign(static_cast<std::size_t>(size.w) * size.h, make_pixel(0u, 0u, 0u));
+    m_stale = false;
+    ++m_revision;
+}
+
+void Surface::clear(Pixel color)
+{
+    std::fill(m_pixels.begin(), m_pixels.end(), color);
+    m_dirty = true;
+    m_stale = false;
+    ++m_revision;
+}
+
+bool Surface::swap_pixels(std::vector<Pixel>& pixels) noexcept
+{
+    if (pixels.size() != m_pixels.size())
+        return false;
+
+    m_pixels.swap(pixels);
+    m_stale = true;
+    return true;
+}
+
+} // namespace Surreal
@@ -0,0 +1,67 @@
+#include <core/system.hpp>
+
+#include <algorithm>
+
+namespace Surreal
+{
+
+SystemScheduler::SystemScheduler(World& world, ThreadPool& pool)
+    : m_world(world), m_pool(pool), m_systems(), m_stages(), m_stages_dirty(false)
+{
+}
+
+void SystemScheduler::run(f32 delta_time)
+{
+    if (m_stages_dirty)
+        build_stages();
+
+    for (const auto& stage : m_stages)
+    {
+        m_pool.parallel_for(static_cast<u32>(stage.size()), [&](u32 i) {
+            System& system{ *m_systems[stage[i]] };
+            system.run(system.commands, delta_time);
+        });
+    }
+
+    for (auto& system : m_systems)
+        if (!system->commands.empty())
+            m_world.flush(system->commands);
+}
+
+std::span<const std::vector<u32>> SystemScheduler::get_stages()
+{
+    if (m_stages_dirty)
+        build_stages();
+    return m_stages;
+}
+
+// Greedy layering: a system goes in the stage after the last stage holding a system it conflicts with.
+void SystemScheduler::build_stages()
+{
+    std::vector<u32> stage_of(m_systems.size(), 0u);
+    m_stages.clear();
+
+    for (u32 i{ 0u }; i < m_systems.size(); ++i)
+    {
+        const System& system{ *m_systems[i] };
+
+        u32 stage{ 0u };
+        for (u32 j{ 0u }; j < i; ++j)
+        {
+            const System& earlier{ *m_systems[j] };
+            const bool conflicts{ system.writes.intersects(earlier.reads | earlier.writes) ||
+                                  earlier.writes.intersects(system.reads | system.writes) };
+            if (conflicts)
+                stage = std::max(stage, stage_of[j] + 1u);
+        }
+
+        stage_of[i] = stage;
+        if (stage >= m_stages.size())
+            m_stages.resize(stage + 1u);
+        m_stages[stage].push_back(i);
+    }
+
+    m_stages_dirty = false;
+}
+
+} // namespace Surreal
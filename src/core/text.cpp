@@ -0,0 +1,540 @@
+#include <core/text.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_ADVANCES_H
+
+namespace Surreal
+{
+
+namespace
+{
+
+constexpr u16 s_no_shelf{ 0xffffu };
+// Gap left around every glyph so filtered sampling on the GPU does not bleed into neighbours.
+constexpr u32 s_glyph_padding{ 1u };
+// Shelves are opened at a multiple of this height so glyphs of one size share them.
+constexpr u32 s_shelf_granularity{ 4u };
+constexpr u64 s_run_lifetime{ 240u };
+constexpr u64 s_run_sweep_interval{ 64u };
+constexpr u32 s_tab_width{ 4u };
+constexpr char32_t s_replacement{ 0xfffdu };
+
+std::atomic<u32> s_next_font_id{ 1u };
+
+constexpr i32 from_26_6(FT_Pos value) noexcept
+{
+    return static_cast<i32>((value + 32) >> 6);
+}
+
+// Invalid sequences decode to U+FFFD one byte at a time.
+char32_t decode_utf8(std::string_view text, std::size_t& i) noexcept
+{
+    const u8 lead{ static_cast<u8>(text[i++]) };
+    if (lead < 0x80u)
+        return lead;
+
+    const u32 length{ (lead & 0xe0u) == 0xc0u   ? 1u
+                      : (lead & 0xf0u) == 0xe0u ? 2u
+                      : (lead & 0xf8u) == 0xf0u ? 3u
+                                                : 0u };
+    if (!length || text.size() - i < length)
+        return s_replacement;
+
+    char32_t codepoint{ lead & (0x3fu >> length) };
+    for (u32 n{ 0u }; n < length; ++n)
+    {
+        const u8 next{ static_cast<u8>(text[i + n]) };
+        if ((next & 0xc0u) != 0x80u)
+            return s_replacement;
+        codepoint = codepoint << 6u | (next & 0x3fu);
+    }
+    i += length;
+    return codepoint;
+}
+
+constexpr u8 blend_channel(u32 src, u32 dst, u32 alpha) noexcept
+{
+    return static_cast<u8>((src * alpha + dst * (255u - alpha) + 127u) / 255u);
+}
+
+} // namespace
+
+Font::Font(const std::string& path, u32 pixel_size)
+    : m_library(nullptr), m_face(nullptr), m_id(s_next_font_id.fetch_add(1u, std::memory_order_relaxed)),
+      m_pixel_size(pixel_size), m_ascender(0), m_line_height(0), m_has_kerning(false), m_ascii_glyphs(), m_glyphs(),
+      m_advances()
+{
+    if (FT_Init_FreeType(&m_library))
+        throw FontError("Failed to initialize FreeType.");
+
+    if (FT_New_Face(m_library, path.c_str(), 0, &m_face))
+    {
+        FT_Done_FreeType(m_library);
+        throw FontError("Failed to load font " + path + ".");
+    }
+
+    if (!FT_IS_SCALABLE(m_face) || FT_Set_Pixel_Sizes(m_face, 0u, pixel_size))
+    {
+        FT_Done_Face(m_face);
+        FT_Done_FreeType(m_library);
+        throw FontError("Font " + path + " cannot be scaled to " + std::to_string(pixel_size) + " pixels.");
+    }
+
+    m_ascender = from_26_6(m_face->size->metrics.ascender);
+    m_line_height = from_26_6(m_face->size->metrics.height);
+    m_has_kerning = FT_HAS_KERNING(m_face);
+
+    for (u32 c{ 0u }; c < m_ascii_glyphs.size(); ++c)
+        m_ascii_glyphs[c] = FT_Get_Char_Index(m_face, c);
+    m_advances.assign(static_cast<std::size_t>(m_face->num_glyphs), -1.0f);
+}
+
+Font::~Font()
+{
+    FT_Done_Face(m_face);
+    FT_Done_FreeType(m_library);
+}
+
+u32 Font::get_glyph_index(char32_t codepoint)
+{
+    if (codepoint < m_ascii_glyphs.size())
+        return m_ascii_glyphs[codepoint];
+
+    const auto it{ m_glyphs.find(codepoint) };
+    if (it != m_glyphs.end())
+        return it->second;
+    return m_glyphs.emplace(codepoint, FT_Get_Char_Index(m_face, codepoint)).first->second;
+}
+
+f32 Font::get_advance(u32 glyph)
+{
+    if (glyph >= m_advances.size())
+        return 0.0f;
+
+    f32& advance{ m_advances[glyph] };
+    if (advance < 0.0f)
+    {
+        FT_Fixed value{ 0 };
+        FT_Get_Advance(m_face, glyph, FT_LOAD_DEFAULT, &value);
+        advance = static_cast<f32>(value) / 65536.0f;
+    }
+    return advance;
+}
+
+f32 Font::get_kerning(u32 left, u32 right) const noexcept
+{
+    if (!m_has_kerning || !left || !right)
+        return 0.0f;
+
+    FT_Vector delta{};
+    FT_Get_Kerning(m_face, left, right, FT_KERNING_DEFAULT, &delta);
+    return static_cast<f32>(delta.x) / 64.0f;
+}
+
+bool Font::rasterize(u32 glyph, GlyphBitmap& out) const
+{
+    if (FT_Load_Glyph(m_face, glyph, FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT))
+        return false;
+
+    const FT_GlyphSlot slot{ m_face->glyph };
+    const FT_Bitmap& bitmap{ slot->bitmap };
+    if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY && bitmap.pixel_mode != FT_PIXEL_MODE_MONO)
+        return false;
+
+    out.width = bitmap.width;
+    out.height = bitmap.rows;
+    out.left = slot->bitmap_left;
+    out.top = slot->bitmap_top;
+    out.coverage.resize(static_cast<std::size_t>(out.width) * out.height);
+
+    for (u32 y{ 0u }; y < out.height; ++y)
+    {
+        const u8* src{ bitmap.buffer + static_cast<std::ptrdiff_t>(y) * bitmap.pitch };
+        u8* dst{ out.coverage.data() + static_cast<std::size_t>(y) * out.width };
+        if (bitmap.pixel_mode == FT_PIXEL_MODE_GRAY)
+            std::memcpy(dst, src, out.width);
+        else
+            for (u32 x{ 0u }; x < out.width; ++x)
+                dst[x] = (src[x >> 3u] & (0x80u >> (x & 7u))) ? 0xffu : 0x00u;
+    }
+    return true;
+}
+
+GlyphAtlas::GlyphAtlas(u32 size)
+    : m_size(size), m_pixels(static_cast<std::size_t>(size) * size), m_shelves(), m_next_shelf_y(0u), m_glyphs(),
+      m_frame(0u), m_dirty(), m_stats(), m_scratch()
+{
+}
+
+const AtlasGlyph* GlyphAtlas::get(Font& font, u32 glyph)
+{
+    const u64 key{ make_key(font.get_id(), glyph) };
+    if (const auto it{ m_glyphs.find(key) }; it != m_glyphs.end())
+    {
+        ++m_stats.hits;
+        if (it->second.shelf != s_no_shelf)
+            m_shelves[it->second.shelf].last_used = m_frame;
+        return &it->second;
+    }
+    ++m_stats.misses;
+
+    if (!font.rasterize(glyph, m_scratch))
+        return nullptr;
+
+    AtlasGlyph entry{ 0u, 0u, static_cast<u16>(m_scratch.width), static_cast<u16>(m_scratch.height),
+                      static_cast<i16>(m_scratch.left), static_cast<i16>(m_scratch.top), s_no_shelf };
+
+    // Blank glyphs such as spaces take no atlas space.
+    if (m_scratch.width && m_scratch.height)
+    {
+        u32 x{ 0u };
+        const i32 shelf_index{ allocate(m_scratch.width + s_glyph_padding, m_scratch.height + s_glyph_padding, x) };
+        if (shelf_index < 0)
+        {
+            ++m_stats.failures;
+            return nullptr;
+        }
+
+        Shelf& shelf{ m_shelves[static_cast<u32>(shelf_index)] };
+        shelf.keys.push_back(key);
+        shelf.last_used = m_frame;
+
+        entry.x = static_cast<u16>(x);
+        entry.y = static_cast<u16>(shelf.y);
+        entry.shelf = static_cast<u16>(shelf_index);
+
+        for (u32 row{ 0u }; row < m_scratch.height; ++row)
+            std::memcpy(m_pixels.data() + static_cast<std::size_t>(shelf.y + row) * m_size + x,
+                        m_scratch.coverage.data() + static_cast<std::size_t>(row) * m_scratch.width,
+                        m_scratch.width);
+        mark_dirty(x, shelf.y, m_scratch.width, m_scratch.height);
+    }
+
+    ++m_stats.glyph_count;
+    return &m_glyphs.emplace(key, entry).first->second;
+}
+
+bool GlyphAtlas::touch(u16 shelf, u32 epoch) noexcept
+{
+    Shelf& s{ m_shelves[shelf] };
+    if (s.epoch != epoch)
+        return false;
+    s.last_used = m_frame;
+    return true;
+}
+
+void GlyphAtlas::reset_stats() noexcept
+{
+    m_stats.hits = 0u;
+    m_stats.misses = 0u;
+    m_stats.evictions = 0u;
+    m_stats.failures = 0u;
+}
+
+i32 GlyphAtlas::allocate(u32 width, u32 height, u32& x)
+{
+    if (width > m_size || height > m_size)
+        return -1;
+
+    const auto place = [&](std::size_t index) {
+        Shelf& shelf{ m_shelves[index] };
+        x = shelf.used_width;
+        shelf.used_width += width;
+        return static_cast<i32>(index);
+    };
+
+    // Tightest shelf with room, preferring ones opened for this height.
+    const u32 shelf_height{ (height + s_shelf_granularity - 1u) / s_shelf_granularity * s_shelf_granularity };
+    std::size_t best{ m_shelves.size() };
+    for (std::size_t i{ 0u }; i < m_shelves.size(); ++i)
+    {
+        const Shelf& shelf{ m_shelves[i] };
+        if (shelf.height >= height && m_size - shelf.used_width >= width &&
+            (best == m_shelves.size() || shelf.height < m_shelves[best].height))
+            best = i;
+    }
+    if (best != m_shelves.size() && m_shelves[best].height <= shelf_height)
+        return place(best);
+
+    if (m_size - m_next_shelf_y >= shelf_height && m_shelves.size() < s_no_shelf)
+    {
+        m_shelves.push_back({ m_next_shelf_y, shelf_height, 0u, 0u, m_frame, {} });
+        m_next_shelf_y += shelf_height;
+        ++m_stats.shelf_count;
+        return place(m_shelves.size() - 1u);
+    }
+
+    if (best != m_shelves.size())
+        return place(best);
+
+    // Out of space: empty the least recently used shelf tall enough, unless the current frame still needs it.
+    std::size_t victim{ m_shelves.size() };
+    for (std::size_t i{ 0u }; i < m_shelves.size(); ++i)
+    {
+        const Shelf& shelf{ m_shelves[i] };
+        if (shelf.height >= height && shelf.last_used != m_frame &&
+            (victim == m_shelves.size() || shelf.last_used < m_shelves[victim].last_used ||
+             (shelf.last_used == m_shelves[victim].last_used && shelf.height < m_shelves[victim].height)))
+            victim = i;
+    }
+    if (victim == m_shelves.size())
+        return -1;
+
+    evict(m_shelves[victim]);
+    return place(victim);
+}
+
+void GlyphAtlas::evict(Shelf& shelf)
+{
+    for (u64 key : shelf.keys)
+        m_glyphs.erase(key);
+    m_stats.glyph_count -= static_cast<u32>(shelf.keys.size());
+    shelf.keys.clear();
+    shelf.used_width = 0u;
+
+    // Stale coverage in the padding would bleed into the glyphs packed here next.
+    std::fill_n(m_pixels.begin() + static_cast<std::ptrdiff_t>(shelf.y) * m_size,
+                static_cast<std::size_t>(shelf.height) * m_size, u8{ 0u });
+    mark_dirty(0u, shelf.y, m_size, shelf.height);
+    ++shelf.epoch;
+    ++m_stats.evictions;
+}
+
+void GlyphAtlas::mark_dirty(u32 x, u32 y, u32 width, u32 height) noexcept
+{
+    if (!m_dirty.size.w)
+    {
+        m_dirty = { { x, y }, { width, height } };
+        return;
+    }
+
+    const u32 x1{ std::max(m_dirty.pos.x + m_dirty.size.w, x + width) };
+    const u32 y1{ std::max(m_dirty.pos.y + m_dirty.size.h, y + height) };
+    m_dirty.pos = { std::min(m_dirty.pos.x, x), std::min(m_dirty.pos.y, y) };
+    m_dirty.size = { x1 - m_dirty.pos.x, y1 - m_dirty.pos.y };
+}
+
+TextRenderer::TextRenderer(u32 atlas_size)
+    : m_atlas(atlas_size), m_runs(), m_commands(), m_previous_commands(), m_batch(), m_stats(), m_frame(0u)
+{
+}
+
+void TextRenderer::begin_frame()
+{
+    ++m_frame;
+    m_atlas.begin_frame();
+    m_commands.clear();
+}
+
+void TextRenderer::draw(Font& font, std::string_view text, i32 x, i32 y, Pixel color)
+{
+    if (!text.empty())
+        m_commands.push_back({ &font, &get_run(font, text), x, y, color });
+}
+
+Size TextRenderer::measure(Font& font, std::string_view text)
+{
+    return text.empty() ? Size{} : get_run(font, text).size;
+}
+
+const TextBatch& TextRenderer::end_frame()
+{
+    // Touching every run keeps the shelves it samples from being evicted while this frame is built, and finds runs
+    // whose shelves were evicted since they were last drawn.
+    bool changed{ m_commands != m_previous_commands };
+    for (const DrawCommand& command : m_commands)
+        changed |= !touch(*command.run);
+
+    m_batch.changed = changed;
+    if (changed)
+    {
+        m_batch.quads.clear();
+        for (const DrawCommand& command : m_commands)
+        {
+            TextRun& run{ *command.run };
+            if (!run.quads_valid)
+                build_quads(*command.font, run);
+
+            for (GlyphQuad quad : run.quads)
+            {
+                quad.x += command.x;
+                quad.y += command.y;
+                quad.color = command.color;
+                m_batch.quads.push_back(quad);
+            }
+        }
+        ++m_stats.batches_built;
+    }
+    else
+        ++m_stats.batches_reused;
+
+    std::swap(m_commands, m_previous_commands);
+    if (m_frame % s_run_sweep_interval == 0u)
+        evict_runs();
+    return m_batch;
+}
+
+void TextRenderer::render(Surface& surface) const
+{
+    const Size size{ surface.get_size() };
+    const std::span<const u8> atlas{ m_atlas.get_pixels() };
+    const u32 atlas_size{ m_atlas.get_size() };
+
+    for (const GlyphQuad& quad : m_batch.quads)
+    {
+        const i32 x0{ std::max(quad.x, 0) };
+        const i32 y0{ std::max(quad.y, 0) };
+        const i32 x1{ std::min(quad.x + quad.width, static_cast<i32>(size.w)) };
+        const i32 y1{ std::min(quad.y + quad.height, static_cast<i32>(size.h)) };
+        if (x0 >= x1 || y0 >= y1)
+            continue;
+
+        const u32 alpha{ quad.color >> 24u };
+        const u32 r{ (quad.color >> 16u) & 0xffu };
+        const u32 g{ (quad.color >> 8u) & 0xffu };
+        const u32 b{ quad.color & 0xffu };
+
+        for (i32 y{ y0 }; y < y1; ++y)
+        {
+            const u8* coverage{ atlas.data() + static_cast<std::size_t>(quad.v + (y - quad.y)) * atlas_size + quad.u +
+                                (x0 - quad.x) };
+            Pixel* dst{ surface.get_row(static_cast<u32>(y)) + x0 };
+            for (i32 x{ x0 }; x < x1; ++x, ++coverage, ++dst)
+            {
+                const u32 a{ *coverage * alpha / 255u };
+                if (!a)
+                    continue;
+                if (a == 255u)
+                {
+                    *dst = quad.color | 0xff000000u;
+                    continue;
+                }
+                const Pixel d{ *dst };
+                *dst = make_pixel(blend_channel(r, (d >> 16u) & 0xffu, a), blend_channel(g, (d >> 8u) & 0xffu, a),
+                                  blend_channel(b, d & 0xffu, a));
+            }
+        }
+    }
+}
+
+TextRenderer::TextRun& TextRenderer::get_run(Font& font, std::string_view text)
+{
+    // Open addressing on top of the map: a colliding string moves on to the next key.
+    for (u64 key{ std::hash<std::string_view>()(text) ^ static_cast<u64>(font.get_id()) * 0x9e3779b97f4a7c15u };;
+         ++key)
+    {
+        const auto [it, inserted]{ m_runs.try_emplace(key) };
+        TextRun& run{ it->second };
+        if (inserted)
+        {
+            ++m_stats.run_misses;
+            ++m_stats.run_count;
+            run.text = text;
+            run.font_id = font.get_id();
+            run.quads_valid = false;
+            shape(font, run);
+        }
+        else if (run.font_id != font.get_id() || run.text != text)
+            continue;
+        else
+            ++m_stats.run_hits;
+
+        run.last_used = m_frame;
+        return run;
+    }
+}
+
+void TextRenderer::shape(Font& font, TextRun& run)
+{
+    run.glyphs.clear();
+
+    const std::string_view text{ run.text };
+    const i32 line_height{ font.get_line_height() };
+    f32 pen{ 0.0f };
+    f32 width{ 0.0f };
+    i32 line{ 0 };
+    u32 previous{ 0u };
+
+    for (std::size_t i{ 0u }; i < text.size();)
+    {
+        const char32_t codepoint{ decode_utf8(text, i) };
+        if (codepoint == U'\n')
+        {
+            width = std::max(width, pen);
+            pen = 0.0f;
+            ++line;
+            previous = 0u;
+            continue;
+        }
+        if (codepoint == U'\t')
+        {
+            pen += static_cast<f32>(s_tab_width) * font.get_advance(font.get_glyph_index(U' '));
+            previous = 0u;
+            continue;
+        }
+
+        const u32 glyph{ font.get_glyph_index(codepoint) };
+        pen += font.get_kerning(previous, glyph);
+        run.glyphs.push_back({ glyph, static_cast<i32>(std::lround(pen)), line * line_height });
+        pen += font.get_advance(glyph);
+        previous = glyph;
+    }
+
+    width = std::max(width, pen);
+    run.size = { static_cast<u32>(std::ceil(width)), static_cast<u32>((line + 1) * line_height) };
+}
+
+void TextRenderer::build_quads(Font& font, TextRun& run)
+{
+    run.quads.clear();
+    run.shelves.clear();
+    run.quads_valid = true;
+
+    const i32 ascender{ font.get_ascender() };
+    for (const ShapedGlyph& shaped : run.glyphs)
+    {
+        const AtlasGlyph* glyph{ m_atlas.get(font, shaped.glyph) };
+        if (!glyph)
+        {
+            // Missing from a full atlas; try again next frame.
+            run.quads_valid = false;
+            continue;
+        }
+        if (!glyph->width)
+            continue;
+
+        run.quads.push_back({ shaped.x + glyph->left, shaped.y + ascender - glyph->top, glyph->width, glyph->height,
+                              glyph->x, glyph->y, 0u });
+
+        if (std::none_of(run.shelves.begin(), run.shelves.end(),
+                         [&](const auto& shelf) { return shelf.first == glyph->shelf; }))
+            run.shelves.emplace_back(glyph->shelf, m_atlas.get_epoch(glyph->shelf));
+    }
+}
+
+bool TextRenderer::touch(TextRun& run) noexcept
+{
+    if (!run.quads_valid)
+        return false;
+
+    for (const auto& [shelf, epoch] : run.shelves)
+        if (!m_atlas.touch(shelf, epoch))
+            run.quads_valid = false;
+    return run.quads_valid;
+}
+
+void TextRenderer::evict_runs()
+{
+    const std::size_t count{ m_runs.size() };
+    std::erase_if(m_runs, [&](const auto& entry) { return entry.second.last_used + s_run_lifetime < m_frame; });
+    m_stats.run_count -= static_cast<u32>(count - m_runs.size());
+}
+
+} // namespace Surreal
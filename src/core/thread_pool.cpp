@@ -0,0 +1,111 @@
+#include <core/thread_pool.hpp>
+#include <core/topology.hpp>
+
+#include <algorithm>
+
+namespace Surreal
+{
+
+ThreadPool::ThreadPool(u32 thread_count)
+    : m_thread_count(thread_count), m_threads(), m_mutex(), m_wake(), m_tasks(), m_started(false), m_stopping(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+u32 ThreadPool::get_default_thread_count() noexcept
+{
+    const u32 hardware_threads{ std::thread::hardware_concurrency() };
+    return hardware_threads > 1u ? hardware_threads - 1u : 0u;
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    if (!m_thread_count)
+    {
+        task();
+        return;
+    }
+
+    {
+        std::scoped_lock lock{ m_mutex };
+        if (!m_started)
+            start();
+        m_tasks.emplace_back(std::move(task));
+    }
+    m_wake.notify_one();
+}
+
+// Called with m_mutex held.
+void ThreadPool::start()
+{
+    m_started = true;
+    m_threads.reserve(m_thread_count);
+    for (u32 i{ 0u }; i < m_thread_count; ++i)
+        m_threads.emplace_back([this, i] {
+            AffinityPlan::apply_current(ThreadRole::Worker, i);
+            worker_loop();
+        });
+}
+
+void ThreadPool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{ m_mutex };
+            m_wake.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::ParallelForState::work() noexcept
+{
+    u32 completed{ 0u };
+    for (u32 i{ next.fetch_add(1u, std::memory_order_relaxed) }; i < count;
+         i = next.fetch_add(1u, std::memory_order_relaxed))
+    {
+        try
+        {
+            func(i);
+        }
+        catch (...)
+        {
+            std::scoped_lock lock{ mutex };
+            if (!error)
+                error = std::current_exception();
+        }
+        ++completed;
+    }
+
+    if (completed && done.fetch_add(completed, std::memory_order_acq_rel) + completed == count)
+    {
+        std::scoped_lock lock{ mutex };
+        finished.notify_all();
+    }
+}
+
+void ThreadPool::ParallelForState::wait()
+{
+    std::unique_lock lock{ mutex };
+    finished.wait(lock, [this] { return done.load(std::memory_order_acquire) == count; });
+}
+
+} // namespace Surreal
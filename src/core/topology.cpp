@@ -0,0 +1,361 @@
+#include <core/topology.hpp>
+
+#include <core/memory.hpp>
+#include <core/thread_pool.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace Surreal
+{
+
+namespace
+{
+
+std::mutex s_current_mutex;
+std::optional<AffinityPlan> s_current;
+
+std::string format_size(u64 bytes)
+{
+    if (bytes >= (u64{ 1u } << 30u) && !(bytes % (u64{ 1u } << 30u)))
+        return fmt::format("{} GiB", bytes >> 30u);
+    if (bytes >= (u64{ 1u } << 20u) && !(bytes % (u64{ 1u } << 20u)))
+        return fmt::format("{} MiB", bytes >> 20u);
+    return fmt::format("{} KiB", bytes >> 10u);
+}
+
+} // namespace
+
+CpuList parse_cpu_list(std::string_view text)
+{
+    CpuList cpus;
+    while (!text.empty())
+    {
+        const std::size_t comma{ text.find(',') };
+        std::string_view range{ text.substr(0u, comma) };
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1u);
+
+        while (!range.empty() && (range.front() == ' ' || range.front() == '\n'))
+            range.remove_prefix(1u);
+        while (!range.empty() && (range.back() == ' ' || range.back() == '\n'))
+            range.remove_suffix(1u);
+
+        u32 first{ 0u };
+        const auto [first_end, first_error]{ std::from_chars(range.data(), range.data() + range.size(), first) };
+        if (first_error != std::errc())
+            continue;
+
+        u32 last{ first };
+        if (first_end != range.data() + range.size())
+        {
+            if (*first_end != '-')
+                continue;
+            const auto [last_end, last_error]{ std::from_chars(first_end + 1, range.data() + range.size(), last) };
+            if (last_error != std::errc() || last_end != range.data() + range.size() || last < first)
+                continue;
+        }
+
+        for (u32 cpu{ first }; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string format_cpu_list(std::span<const u32> cpus)
+{
+    std::string text;
+    for (std::size_t i{ 0u }; i < cpus.size();)
+    {
+        std::size_t j{ i };
+        while (j + 1u < cpus.size() && cpus[j + 1u] == cpus[j] + 1u)
+            ++j;
+
+        if (!text.empty())
+            text += ',';
+        text += j == i ? fmt::format("{}", cpus[i]) : fmt::format("{}-{}", cpus[i], cpus[j]);
+        i = j + 1u;
+    }
+    return text;
+}
+
+u32 CpuTopology::get_cpu_count() const noexcept
+{
+    u32 count{ 0u };
+    for (const CpuCore& core : m_cores)
+        count += static_cast<u32>(core.cpus.size());
+    return count;
+}
+
+u32 CpuTopology::get_node_of(u32 cpu) const noexcept
+{
+    const u32 core{ get_core_of(cpu) };
+    return core == s_invalid ? s_invalid : m_cores[core].node;
+}
+
+bool CpuTopology::is_isolated(u32 cpu) const noexcept
+{
+    return std::binary_search(m_isolated.begin(), m_isolated.end(), cpu);
+}
+
+std::string CpuTopology::describe() const
+{
+    u32 packages{ 0u };
+    for (const CpuCore& core : m_cores)
+        packages = std::max(packages, core.package + 1u);
+
+    std::string text{ fmt::format("{} package(s), {} node(s), {} core(s), {} CPU(s)", packages, m_nodes.size(),
+                                  m_cores.size(), get_cpu_count()) };
+    if (!m_isolated.empty())
+        text += fmt::format(", isolated {}", format_cpu_list(m_isolated));
+
+    for (const NumaNode& node : m_nodes)
+        text += fmt::format("\n  node {}: cpus {}, {} memory", node.id, format_cpu_list(node.cpus),
+                            format_size(node.memory));
+
+    // One line per cache level, counting instances rather than listing them.
+    for (u32 level{ 1u }; level <= 4u; ++level)
+    {
+        u32 instances{ 0u };
+        const CpuCache* sample{ nullptr };
+        for (const CpuCache& cache : m_caches)
+            if (cache.level == level)
+                ++instances, sample = &cache;
+        if (sample)
+            text += fmt::format("\n  L{}: {} x{}, {} CPU(s) each, {} B lines", level, format_size(sample->size),
+                                instances, sample->cpus.size(), sample->line_size);
+    }
+    return text;
+}
+
+// Threads start with their creator's CPUs, so a role the plan leaves unpinned gets the whole process mask back
+// rather than staying on the pinned CPU of whoever started it.
+static bool place_thread(const ThreadPlacement& placement)
+{
+    if (placement.cpus.empty())
+    {
+        const CpuList& cpus{ get_process_cpus() };
+        return cpus.empty() || set_thread_affinity(cpus);
+    }
+
+    if (!set_thread_affinity(placement.cpus))
+        return false;
+    Memory::set_thread_node(placement.node);
+    return true;
+}
+
+AffinityPlan AffinityPlan::build(const CpuTopology& topology, const AffinityPolicy& policy)
+{
+    AffinityPlan plan;
+    plan.m_main = { ThreadRole::Main, 0u, 0u, {} };
+    plan.m_input = { ThreadRole::Input, 0u, 0u, {} };
+    plan.m_io = { ThreadRole::Io, 0u, 0u, {} };
+    plan.m_log = { ThreadRole::Log, 0u, 0u, {} };
+
+    const std::span<const CpuCore> cores{ topology.get_cores() };
+    if (!policy.enabled || cores.empty())
+    {
+        // Sized from the topology rather than the host, so a taskset or cpuset limit also limits the pool.
+        u32 worker_count{ ThreadPool::get_default_thread_count() };
+        if (const u32 cpu_count{ topology.get_cpu_count() })
+            worker_count = cpu_count - 1u;
+        for (u32 i{ 0u }; i < worker_count; ++i)
+            plan.m_workers.push_back({ ThreadRole::Worker, i, 0u, {} });
+        return plan;
+    }
+    plan.m_enabled = true;
+
+    const std::span<const NumaNode> nodes{ topology.get_nodes() };
+    const bool has_main_node{ std::any_of(nodes.begin(), nodes.end(),
+                                          [&](const NumaNode& node) { return node.id == policy.main_node; }) };
+    const u32 main_node{ has_main_node ? policy.main_node : cores.front().node };
+
+    u32 cpu_limit{ 0u };
+    for (const CpuCore& core : cores)
+        for (u32 cpu : core.cpus)
+            cpu_limit = std::max(cpu_limit, cpu + 1u);
+    std::vector<bool> reserved(cpu_limit, false);
+
+    const auto reserve = [&](u32 cpu) {
+        if (policy.reserve_siblings)
+            for (u32 sibling : cores[topology.get_core_of(cpu)].cpus)
+                reserved[sibling] = true;
+        else
+            reserved[cpu] = true;
+    };
+
+    // Isolated CPUs first, then the first CPU of each core on the main node. Core 0 goes last: it usually takes the
+    // interrupts and housekeeping work nobody else was pinned away from.
+    CpuList candidates;
+    if (policy.use_isolated_cpus)
+        for (u32 cpu : topology.get_isolated_cpus())
+            if (topology.get_node_of(cpu) == main_node)
+                candidates.push_back(cpu);
+    const std::size_t isolated_candidates{ candidates.size() };
+
+    std::vector<const CpuCore*> main_cores;
+    for (const CpuCore& core : cores)
+        if (core.node == main_node && !core.cpus.empty())
+            main_cores.push_back(&core);
+    std::rotate(main_cores.begin(), main_cores.begin() + (main_cores.size() > 1u ? 1 : 0), main_cores.end());
+    for (const CpuCore* core : main_cores)
+        if (!topology.is_isolated(core->cpus.front()))
+            candidates.push_back(core->cpus.front());
+
+    if (candidates.empty())
+        candidates.push_back(cores.front().cpus.front());
+
+    const u32 main_cpu{ candidates.front() };
+    plan.m_main = { ThreadRole::Main, 0u, topology.get_node_of(main_cpu), { main_cpu } };
+    reserve(main_cpu);
+
+    // The input thread only gets a core of its own if that leaves at least two on the node for everything else.
+    const auto free_cores = [&] {
+        return std::count_if(main_cores.begin(), main_cores.end(), [&](const CpuCore* core) {
+            return std::any_of(core->cpus.begin(), core->cpus.end(), [&](u32 cpu) { return !reserved[cpu]; });
+        });
+    };
+    for (std::size_t i{ 1u }; i < candidates.size(); ++i)
+    {
+        const u32 cpu{ candidates[i] };
+        if (reserved[cpu] || (i >= isolated_candidates && free_cores() <= 2))
+            continue;
+        plan.m_input = { ThreadRole::Input, 0u, topology.get_node_of(cpu), { cpu } };
+        reserve(cpu);
+        break;
+    }
+    if (plan.m_input.cpus.empty())
+        plan.m_input = { ThreadRole::Input, 0u, plan.m_main.node, plan.m_main.cpus };
+
+    const auto usable = [&](u32 cpu) { return !reserved[cpu] && !topology.is_isolated(cpu); };
+
+    // One worker per physical core, grouped by node so consecutive indices share memory. The main node comes first,
+    // so a max_workers limit keeps the workers next to the main loop.
+    std::vector<const CpuCore*> worker_cores;
+    for (const CpuCore& core : cores)
+        if (!policy.workers_on_main_node || core.node == main_node)
+            worker_cores.push_back(&core);
+    std::stable_sort(worker_cores.begin(), worker_cores.end(), [&](const CpuCore* a, const CpuCore* b) {
+        return std::pair(a->node != main_node, a->node) < std::pair(b->node != main_node, b->node);
+    });
+    for (const CpuCore* core : worker_cores)
+    {
+        if (policy.max_workers && plan.m_workers.size() >= policy.max_workers)
+            break;
+
+        CpuList cpus;
+        std::copy_if(core->cpus.begin(), core->cpus.end(), std::back_inserter(cpus), usable);
+        if (!cpus.empty())
+            plan.m_workers.push_back(
+                { ThreadRole::Worker, static_cast<u32>(plan.m_workers.size()), core->node, std::move(cpus) });
+    }
+
+    // I/O and logging float over whatever the main node has left, sharing it with its workers.
+    CpuList housekeeping;
+    for (const CpuCore* core : main_cores)
+        std::copy_if(core->cpus.begin(), core->cpus.end(), std::back_inserter(housekeeping), usable);
+    if (housekeeping.empty())
+        for (const CpuCore& core : cores)
+            std::copy_if(core.cpus.begin(), core.cpus.end(), std::back_inserter(housekeeping), usable);
+    if (housekeeping.empty())
+        housekeeping = plan.m_main.cpus;
+    std::sort(housekeeping.begin(), housekeeping.end());
+
+    plan.m_io = { ThreadRole::Io, 0u, topology.get_node_of(housekeeping.front()), housekeeping };
+    plan.m_log = { ThreadRole::Log, 0u, plan.m_io.node, std::move(housekeeping) };
+    return plan;
+}
+
+u32 AffinityPlan::get_worker_count() const noexcept
+{
+    return static_cast<u32>(m_workers.size());
+}
+
+const ThreadPlacement& AffinityPlan::get(ThreadRole role, u32 index) const noexcept
+{
+    static const ThreadPlacement s_unplaced{ ThreadRole::Worker, 0u, 0u, {} };
+
+    switch (role)
+    {
+    case ThreadRole::Main:
+        return m_main;
+    case ThreadRole::Input:
+        return m_input;
+    case ThreadRole::Worker:
+        return m_workers.empty() ? s_unplaced : m_workers[index % m_workers.size()];
+    case ThreadRole::Io:
+        return m_io;
+    case ThreadRole::Log:
+        return m_log;
+    }
+    return s_unplaced;
+}
+
+std::vector<ThreadPlacement> AffinityPlan::get_placements() const
+{
+    std::vector<ThreadPlacement> placements{ m_main, m_input };
+    placements.insert(placements.end(), m_workers.begin(), m_workers.end());
+    placements.push_back(m_io);
+    placements.push_back(m_log);
+    return placements;
+}
+
+std::string AffinityPlan::describe() const
+{
+    if (!m_enabled)
+        return fmt::format("affinity disabled, {} unpinned worker(s)", m_workers.size());
+
+    std::string text;
+    for (const ThreadPlacement& placement : get_placements())
+    {
+        if (!text.empty())
+            text += '\n';
+        const std::string name{ placement.role == ThreadRole::Worker
+                                    ? fmt::format("{}{}", to_string(placement.role), placement.index)
+                                    : std::string(to_string(placement.role)) };
+        text += fmt::format("{:<9} node {} cpus {}", name, placement.node, format_cpu_list(placement.cpus));
+    }
+    return text;
+}
+
+bool AffinityPlan::apply(ThreadRole role, u32 index) const
+{
+    return !m_enabled || place_thread(get(role, index));
+}
+
+void AffinityPlan::set_current(const AffinityPlan& plan)
+{
+    std::scoped_lock lock{ s_current_mutex };
+    s_current = plan;
+}
+
+void AffinityPlan::clear_current()
+{
+    std::scoped_lock lock{ s_current_mutex };
+    s_current.reset();
+}
+
+bool AffinityPlan::apply_current(ThreadRole role, u32 index)
+{
+    ThreadPlacement placement;
+    bool enabled{ false };
+    {
+        std::scoped_lock lock{ s_current_mutex };
+        if (!s_current)
+            return true;
+        placement = s_current->get(role, index);
+        enabled = s_current->m_enabled;
+    }
+
+    return !enabled || place_thread(placement);
+}
+
+} // namespace Surreal
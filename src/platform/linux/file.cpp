@@ -0,0 +1,443 @@
+#include <platform/linux/file.hpp>
+
+#include <core/log.hpp>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace Surreal
+{
+
+static std::string errno_message(const char* what)
+{
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+MappedFile::MappedFile(const std::string& path) : m_handle(-1), m_data(nullptr), m_size(0u)
+{
+    m_handle = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_handle < 0)
+        throw FileError(errno_message(("Failed to open " + path).c_str()));
+
+    struct stat info;
+    if (::fstat(m_handle, &info) != 0)
+    {
+        ::close(m_handle);
+        throw FileError(errno_message(("Failed to stat " + path).c_str()));
+    }
+
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (!m_size)
+        return;
+
+    void* data{ ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_handle, 0) };
+    if (data == MAP_FAILED)
+    {
+        ::close(m_handle);
+        throw FileError(errno_message(("Failed to map " + path).c_str()));
+    }
+    m_data = static_cast<const u8*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        ::munmap(const_cast<u8*>(m_data), m_size);
+    ::close(m_handle);
+}
+
+void MappedFile::prefetch(u64 offset, u64 size) const noexcept
+{
+    if (!m_data || offset >= m_size)
+        return;
+
+    static const u64 s_page_size{ static_cast<u64>(::sysconf(_SC_PAGESIZE)) };
+    const u64 begin{ offset & ~(s_page_size - 1u) };
+    const u64 end{ std::min<u64>(offset + size, m_size) };
+    ::madvise(const_cast<u8*>(m_data) + begin, end - begin, MADV_WILLNEED);
+}
+
+OutputFile::OutputFile(const std::string& path, bool direct) : m_handle(-1), m_direct(false)
+{
+    constexpr int flags{ O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC };
+    if (direct)
+    {
+        // tmpfs and some FUSE file systems reject O_DIRECT at open time.
+        m_handle = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        m_direct = m_handle >= 0;
+    }
+    if (m_handle < 0)
+        m_handle = ::open(path.c_str(), flags, 0644);
+    if (m_handle < 0)
+        throw FileError(errno_message(("Failed to create " + path).c_str()));
+}
+
+OutputFile::~OutputFile()
+{
+    ::close(m_handle);
+}
+
+void OutputFile::truncate(u64 size)
+{
+    if (::ftruncate(m_handle, static_cast<off_t>(size)) != 0)
+        throw FileError(errno_message("Failed to truncate output file"));
+}
+
+static int io_uring_setup(u32 entries, io_uring_params* params) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// io_uring reads and writes take a 32-bit length; larger buffers are transferred in pieces.
+static constexpr std::size_t s_max_transfer_size{ 1u << 30u };
+
+IoUringQueue::IoUringQueue(u32 queue_depth)
+    : m_ring_fd(-1), m_wake_fd(-1), m_ring(MAP_FAILED), m_ring_size(0u), m_sqes(nullptr), m_sqes_size(0u),
+      m_sq_head(nullptr), m_sq_tail(nullptr), m_sq_array(nullptr), m_sq_mask(0u), m_sq_entries(0u),
+      m_cq_head(nullptr), m_cq_tail(nullptr), m_cq_mask(0u), m_cqes(nullptr), m_to_submit(0u), m_operations(),
+      m_free_slots(), m_wake_value(0u)
+{
+    io_uring_params params{};
+    // One extra entry for the armed wake read.
+    m_ring_fd = io_uring_setup(queue_depth + 1u, &params);
+    if (m_ring_fd < 0)
+        throw FileError(errno_message("io_uring_setup failed"));
+
+    // SINGLE_MMAP arrived in 5.4; FAST_POLL in 5.7 implies IORING_OP_READ and IORING_OP_WRITE (5.6).
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_FAST_POLL))
+    {
+        release();
+        throw FileError("Kernel io_uring is too old (needs 5.7 or newer).");
+    }
+
+    m_ring_size = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(u32),
+                                        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    m_ring = ::mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                    IORING_OFF_SQ_RING);
+    if (m_ring == MAP_FAILED)
+    {
+        release();
+        throw FileError(errno_message("Failed to map io_uring rings"));
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes{ ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                       IORING_OFF_SQES) };
+    if (sqes == MAP_FAILED)
+    {
+        release();
+        throw FileError(errno_message("Failed to map io_uring submission entries"));
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto* ring{ static_cast<u8*>(m_ring) };
+    m_sq_head = reinterpret_cast<u32*>(ring + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<u32*>(ring + params.sq_off.tail);
+    m_sq_array = reinterpret_cast<u32*>(ring + params.sq_off.array);
+    m_sq_mask = *reinterpret_cast<u32*>(ring + params.sq_off.ring_mask);
+    m_sq_entries = params.sq_entries;
+    m_cq_head = reinterpret_cast<u32*>(ring + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<u32*>(ring + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<u32*>(ring + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    m_wake_fd = ::eventfd(0u, EFD_CLOEXEC);
+    if (m_wake_fd < 0)
+    {
+        release();
+        throw FileError(errno_message("Failed to create io_uring wake event"));
+    }
+    push(s_wake_token, IORING_OP_READ, m_wake_fd, 0u, &m_wake_value, sizeof(m_wake_value));
+}
+
+IoUringQueue::~IoUringQueue()
+{
+    release();
+}
+
+void IoUringQueue::release() noexcept
+{
+    // Closing the ring cancels whatever is still in flight.
+    if (m_ring_fd >= 0)
+        ::close(m_ring_fd);
+    if (m_wake_fd >= 0)
+        ::close(m_wake_fd);
+    if (m_sqes)
+        ::munmap(m_sqes, m_sqes_size);
+    if (m_ring != MAP_FAILED)
+        ::munmap(m_ring, m_ring_size);
+
+    m_ring_fd = -1;
+    m_wake_fd = -1;
+    m_sqes = nullptr;
+    m_ring = MAP_FAILED;
+}
+
+void IoUringQueue::read(FileHandle file, u64 offset, std::span<u8> buffer, u64 user)
+{
+    start_operation(IORING_OP_READ, file, offset, buffer.data(), buffer.size(), user);
+}
+
+void IoUringQueue::write(FileHandle file, u64 offset, std::span<const u8> buffer, u64 user)
+{
+    // The kernel only reads from the buffer; the operation table just has one pointer type for both directions.
+    start_operation(IORING_OP_WRITE, file, offset, const_cast<u8*>(buffer.data()), buffer.size(), user);
+}
+
+void IoUringQueue::start_operation(u8 opcode, FileHandle file, u64 offset, u8* data, std::size_t size, u64 user)
+{
+    u32 slot;
+    if (m_free_slots.empty())
+    {
+        slot = static_cast<u32>(m_operations.size());
+        m_operations.emplace_back();
+    }
+    else
+    {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+
+    m_operations[slot] = { opcode, file, offset, data, size, user, 0u };
+    push_operation(slot);
+}
+
+void IoUringQueue::push_operation(u32 slot)
+{
+    Operation& op{ m_operations[slot] };
+    const std::size_t size{ std::min(op.size - op.done, s_max_transfer_size) };
+    push(slot, op.opcode, op.file, op.offset + op.done, op.data + op.done, static_cast<u32>(size));
+}
+
+void IoUringQueue::push(u64 user_data, u8 opcode, FileHandle file, u64 offset, void* buffer, u32 size)
+{
+    // Without SQPOLL the kernel consumes every submitted entry during io_uring_enter, so submitting frees the ring.
+    if (*m_sq_tail - std::atomic_ref<u32>(*m_sq_head).load(std::memory_order_acquire) == m_sq_entries)
+        enter(0u);
+
+    const u32 tail{ *m_sq_tail };
+    const u32 index{ tail & m_sq_mask };
+
+    io_uring_sqe& sqe{ m_sqes[index] };
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = opcode;
+    sqe.fd = file;
+    sqe.off = offset;
+    sqe.addr = reinterpret_cast<u64>(buffer);
+    sqe.len = size;
+    sqe.user_data = user_data;
+
+    m_sq_array[index] = index;
+    std::atomic_ref<u32>(*m_sq_tail).store(tail + 1u, std::memory_order_release);
+    ++m_to_submit;
+}
+
+void IoUringQueue::enter(u32 min_complete)
+{
+    const u32 flags{ min_complete ? u32(IORING_ENTER_GETEVENTS) : 0u };
+    while (io_uring_enter(m_ring_fd, m_to_submit, min_complete, flags) < 0)
+    {
+        // EBUSY: the completion ring is full; the caller reaps it before entering again.
+        if (errno == EBUSY)
+            return;
+        if (errno != EINTR && errno != EAGAIN)
+            throw FileError(errno_message("io_uring_enter failed"));
+    }
+    m_to_submit = 0u;
+}
+
+void IoUringQueue::wait(std::vector<IoCompletion>& out)
+{
+    const std::size_t first{ out.size() };
+    bool woken{ false };
+
+    while (out.size() == first && !woken)
+    {
+        u32 head{ *m_cq_head };
+        const bool ready{ head != std::atomic_ref<u32>(*m_cq_tail).load(std::memory_order_acquire) };
+        if (!ready || m_to_submit)
+            enter(ready ? 0u : 1u);
+
+        for (const u32 tail{ std::atomic_ref<u32>(*m_cq_tail).load(std::memory_order_acquire) }; head != tail; ++head)
+        {
+            const io_uring_cqe cqe{ m_cqes[head & m_cq_mask] };
+            std::atomic_ref<u32>(*m_cq_head).store(head + 1u, std::memory_order_release);
+
+            if (cqe.user_data == s_wake_token)
+            {
+                woken = true;
+                push(s_wake_token, IORING_OP_READ, m_wake_fd, 0u, &m_wake_value, sizeof(m_wake_value));
+                continue;
+            }
+
+            const auto slot{ static_cast<u32>(cqe.user_data) };
+            Operation& op{ m_operations[slot] };
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN)
+            {
+                push_operation(slot);
+                continue;
+            }
+
+            i32 error{ 0 };
+            if (cqe.res < 0)
+                error = -cqe.res;
+            else if (cqe.res == 0)
+                error = EIO; // The file is shorter than the read, or the device took nothing.
+            else if ((op.done += static_cast<std::size_t>(cqe.res)) < op.size)
+            {
+                push_operation(slot);
+                continue;
+            }
+
+            out.push_back({ op.user, error });
+            m_free_slots.push_back(slot);
+        }
+    }
+}
+
+void IoUringQueue::wake() noexcept
+{
+    const u64 one{ 1u };
+    [[maybe_unused]] const auto written{ ::write(m_wake_fd, &one, sizeof(one)) };
+}
+
+ThreadPoolQueue::ThreadPoolQueue(ThreadPool& pool)
+    : m_pool(pool), m_mutex(), m_signal(), m_completions(), m_outstanding(0u), m_woken(false)
+{
+}
+
+ThreadPoolQueue::~ThreadPoolQueue()
+{
+    std::unique_lock lock{ m_mutex };
+    m_signal.wait(lock, [this] { return !m_outstanding; });
+}
+
+static i32 read_fully(FileHandle file, u64 offset, std::span<u8> buffer) noexcept
+{
+    std::size_t done{ 0u };
+    while (done < buffer.size())
+    {
+        const ssize_t n{ ::pread(file, buffer.data() + done, buffer.size() - done,
+                                 static_cast<off_t>(offset + done)) };
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno;
+        if (n == 0)
+            return EIO;
+        done += static_cast<std::size_t>(n);
+    }
+    return 0;
+}
+
+static i32 write_fully(FileHandle file, u64 offset, std::span<const u8> buffer) noexcept
+{
+    std::size_t done{ 0u };
+    while (done < buffer.size())
+    {
+        const ssize_t n{ ::pwrite(file, buffer.data() + done, buffer.size() - done,
+                                  static_cast<off_t>(offset + done)) };
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno;
+        if (n == 0)
+            return EIO;
+        done += static_cast<std::size_t>(n);
+    }
+    return 0;
+}
+
+template <typename FuncTp>
+void ThreadPoolQueue::run(u64 user, FuncTp&& func)
+{
+    {
+        std::scoped_lock lock{ m_mutex };
+        ++m_outstanding;
+    }
+
+    m_pool.submit([this, user, func = std::forward<FuncTp>(func)] {
+        const i32 error{ func() };
+
+        // Notified under the lock: the destructor may return as soon as it sees the count drop.
+        std::scoped_lock lock{ m_mutex };
+        m_completions.push_back({ user, error });
+        --m_outstanding;
+        m_signal.notify_all();
+    });
+}
+
+void ThreadPoolQueue::read(FileHandle file, u64 offset, std::span<u8> buffer, u64 user)
+{
+    run(user, [file, offset, buffer] { return read_fully(file, offset, buffer); });
+}
+
+void ThreadPoolQueue::write(FileHandle file, u64 offset, std::span<const u8> buffer, u64 user)
+{
+    run(user, [file, offset, buffer] { return write_fully(file, offset, buffer); });
+}
+
+void ThreadPoolQueue::wait(std::vector<IoCompletion>& out)
+{
+    std::unique_lock lock{ m_mutex };
+    m_signal.wait(lock, [this] { return !m_completions.empty() || m_woken; });
+
+    out.insert(out.end(), m_completions.begin(), m_completions.end());
+    m_completions.clear();
+    m_woken = false;
+}
+
+void ThreadPoolQueue::wake() noexcept
+{
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_woken = true;
+    }
+    m_signal.notify_all();
+}
+
+std::unique_ptr<AsyncReader> AsyncReader::create(ThreadPool& pool, SURREAL_UNUSED(u32, queue_depth))
+{
+#if SURREAL_USE_IO_URING
+    try
+    {
+        return std::make_unique<IoUringQueue>(queue_depth);
+    }
+    catch (const FileError& e)
+    {
+        SURREAL_LOG_INFO("io_uring unavailable ({}), reading on the thread pool instead.", e.what());
+    }
+#endif
+    return std::make_unique<ThreadPoolQueue>(pool);
+}
+
+std::unique_ptr<AsyncWriter> AsyncWriter::create(ThreadPool& pool, SURREAL_UNUSED(u32, queue_depth))
+{
+#if SURREAL_USE_IO_URING
+    try
+    {
+        return std::make_unique<IoUringQueue>(queue_depth);
+    }
+    catch (const FileError& e)
+    {
+        SURREAL_LOG_INFO("io_uring unavailable ({}), writing on the thread pool instead.", e.what());
+    }
+#endif
+    return std::make_unique<ThreadPoolQueue>(pool);
+}
+
+} // namespace Surreal
@@ -0,0 +1,239 @@
+#include <core/topology.hpp>
+
+#include <core/log.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+namespace Surreal
+{
+
+static constexpr unsigned long s_mpol_preferred{ 1u };
+
+static std::string read_text(const std::string& path)
+{
+    std::ifstream file{ path };
+    if (!file)
+        return {};
+
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+static u64 read_number(const std::string& path, u64 fallback)
+{
+    const std::string text{ read_text(path) };
+    u64 value{ 0u };
+    const auto [end, error]{ std::from_chars(text.data(), text.data() + text.size(), value) };
+    return error == std::errc() ? value : fallback;
+}
+
+// "48K", "1280K", "32M": the cache size format of sysfs.
+static u64 parse_size(std::string_view text)
+{
+    u64 value{ 0u };
+    const auto [end, error]{ std::from_chars(text.data(), text.data() + text.size(), value) };
+    if (error != std::errc())
+        return 0u;
+    if (end != text.data() + text.size())
+    {
+        if (*end == 'K')
+            value <<= 10u;
+        else if (*end == 'M')
+            value <<= 20u;
+        else if (*end == 'G')
+            value <<= 30u;
+    }
+    return value;
+}
+
+// "Node 0 MemTotal:       16318440 kB"
+static u64 read_node_memory(const std::string& path)
+{
+    std::ifstream file{ path };
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const std::size_t key{ line.find("MemTotal:") };
+        if (key == std::string::npos)
+            continue;
+
+        std::istringstream fields{ line.substr(key + 9u) };
+        u64 kilobytes{ 0u };
+        fields >> kilobytes;
+        return kilobytes << 10u;
+    }
+    return 0u;
+}
+
+CpuTopology CpuTopology::detect(const std::string& sysfs_root)
+{
+    CpuTopology topology;
+    const std::string cpu_root{ sysfs_root + "/cpu" };
+    const std::string node_root{ sysfs_root + "/node" };
+
+    // CPUs outside the process's mask (taskset, a cgroup cpuset) can be neither pinned to nor counted on.
+    CpuList online{ parse_cpu_list(read_text(cpu_root + "/online")) };
+    const CpuList& allowed{ get_process_cpus() };
+    if (!online.empty() && !allowed.empty())
+    {
+        CpuList usable;
+        std::set_intersection(online.begin(), online.end(), allowed.begin(), allowed.end(),
+                              std::back_inserter(usable));
+        if (usable.empty())
+            SURREAL_LOG_WARN("None of the CPUs {} in {} are in the process's CPU mask {}; ignoring the mask.",
+                             format_cpu_list(online), sysfs_root, format_cpu_list(allowed));
+        else
+            online = std::move(usable);
+    }
+
+    if (online.empty())
+    {
+        CpuList cpus{ allowed };
+        if (cpus.empty())
+            for (u32 cpu{ 0u }; cpu < std::max(std::thread::hardware_concurrency(), 1u); ++cpu)
+                cpus.push_back(cpu);
+        SURREAL_LOG_WARN("Could not read the CPU topology from {}, assuming {} independent CPU(s).", sysfs_root,
+                         cpus.size());
+
+        topology.m_cpu_cores.assign(cpus.back() + 1u, s_invalid);
+        topology.m_nodes.push_back({ 0u, 0u, cpus });
+        for (u32 cpu : cpus)
+        {
+            topology.m_cpu_cores[cpu] = static_cast<u32>(topology.m_cores.size());
+            topology.m_cores.push_back({ 0u, 0u, { cpu } });
+        }
+        return topology;
+    }
+
+    topology.m_cpu_cores.assign(online.back() + 1u, s_invalid);
+    const auto is_online = [&](u32 cpu) { return std::binary_search(online.begin(), online.end(), cpu); };
+
+    for (u32 cpu : online)
+    {
+        if (topology.m_cpu_cores[cpu] != s_invalid)
+            continue;
+
+        const std::string path{ fmt::format("{}/cpu{}/topology/", cpu_root, cpu) };
+        std::string siblings_text{ read_text(path + "core_cpus_list") };
+        if (siblings_text.empty())
+            siblings_text = read_text(path + "thread_siblings_list");
+
+        CpuList siblings;
+        for (u32 sibling : parse_cpu_list(siblings_text))
+            if (is_online(sibling) && topology.m_cpu_cores[sibling] == s_invalid)
+                siblings.push_back(sibling);
+        if (!std::binary_search(siblings.begin(), siblings.end(), cpu))
+            siblings.insert(std::lower_bound(siblings.begin(), siblings.end(), cpu), cpu);
+
+        const u32 core{ static_cast<u32>(topology.m_cores.size()) };
+        for (u32 sibling : siblings)
+            topology.m_cpu_cores[sibling] = core;
+        topology.m_cores.push_back(
+            { static_cast<u32>(read_number(path + "physical_package_id", 0u)), 0u, std::move(siblings) });
+    }
+
+    for (u32 id : parse_cpu_list(read_text(node_root + "/online")))
+    {
+        const std::string path{ fmt::format("{}/node{}/", node_root, id) };
+        CpuList cpus;
+        for (u32 cpu : parse_cpu_list(read_text(path + "cpulist")))
+            if (is_online(cpu))
+                cpus.push_back(cpu);
+        // Memory-only nodes have nothing to place threads on.
+        if (cpus.empty())
+            continue;
+
+        for (u32 cpu : cpus)
+            topology.m_cores[topology.m_cpu_cores[cpu]].node = id;
+        topology.m_nodes.push_back({ id, read_node_memory(path + "meminfo"), std::move(cpus) });
+    }
+    if (topology.m_nodes.empty())
+        topology.m_nodes.push_back({ 0u, 0u, online });
+
+    for (u32 cpu : online)
+    {
+        for (u32 index{ 0u };; ++index)
+        {
+            const std::string path{ fmt::format("{}/cpu{}/cache/index{}/", cpu_root, cpu, index) };
+            const u64 level{ read_number(path + "level", 0u) };
+            if (!level)
+                break;
+
+            std::string type{ read_text(path + "type") };
+            if (type.starts_with("Instruction"))
+                continue;
+
+            CpuList cpus{ parse_cpu_list(read_text(path + "shared_cpu_list")) };
+            if (cpus.empty())
+                cpus.push_back(cpu);
+            // Every CPU sharing the cache lists it again.
+            const auto same{ [&](const CpuCache& cache) { return cache.level == level && cache.cpus == cpus; } };
+            const bool seen{ std::any_of(topology.m_caches.begin(), topology.m_caches.end(), same) };
+            if (!seen)
+                topology.m_caches.push_back({ static_cast<u32>(level), parse_size(read_text(path + "size")),
+                                              static_cast<u32>(read_number(path + "coherency_line_size", 64u)),
+                                              std::move(cpus) });
+        }
+    }
+
+    for (u32 cpu : parse_cpu_list(read_text(cpu_root + "/isolated")))
+        if (is_online(cpu))
+            topology.m_isolated.push_back(cpu);
+
+    return topology;
+}
+
+const CpuList& get_process_cpus()
+{
+    // Read once, before the first pin, so it stays the mask the process was started with.
+    static const CpuList s_cpus{ [] {
+        CpuList cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set))
+            return cpus;
+
+        for (u32 cpu{ 0u }; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+        return cpus;
+    }() };
+    return s_cpus;
+}
+
+bool set_thread_affinity(std::span<const u32> cpus) noexcept
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32 cpu : cpus)
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+
+    const int result{ pthread_setaffinity_np(pthread_self(), sizeof(set), &set) };
+    if (result)
+        SURREAL_LOG_WARN("Failed to pin thread to CPUs {}: error {}.", format_cpu_list(cpus), result);
+    return !result;
+}
+
+bool bind_memory_to_node(void* ptr, std::size_t size, u32 node) noexcept
+{
+    if (node >= 64u)
+        return false;
+
+    // Preferred rather than bound: a full node falls back to the others instead of failing the allocation.
+    const unsigned long mask{ 1ul << node };
+    return !::syscall(SYS_mbind, ptr, size, s_mpol_preferred, &mask, 65ul, 0u);
+}
+
+} // namespace Surreal
@@ -2,24 +2,207 @@
 
 #include <core/event.hpp>
 #include <core/exception.hpp>
+#include <core/log.hpp>
 
-#include <fmt/format.h>
+#include <algorithm>
+#include <span>
+#include <utility>
 
 namespace Surreal
 {
 
 static constexpr u32 s_width{ 1280u };
 static constexpr u32 s_height{ 720u };
+static constexpr std::size_t s_raw_motion_reserve{ 256u };
 
 xcb_connection_t* LinuxWindow::s_connection{ nullptr };
 u32 LinuxWindow::s_window_count{ 0u };
+u8 LinuxWindow::s_xinput_opcode{ 0u };
+
+static constexpr MouseButton to_mouse_button(xcb_button_t button) noexcept
+{
+    switch (button)
+    {
+    case 1:
+        return MouseButton::Left;
+    case 2:
+        return MouseButton::Middle;
+    case 3:
+        return MouseButton::Right;
+    case 8:
+        return MouseButton::Back;
+    case 9:
+        return MouseButton::Forward;
+    default:
+        return MouseButton::Unknown;
+    }
+}
+
+static constexpr Key offset_key(Key first, xcb_keysym_t offset) noexcept
+{
+    return static_cast<Key>(static_cast<u16>(first) + offset);
+}
+
+// Keysym values from X11/keysymdef.h.
+static constexpr Key keysym_to_key(xcb_keysym_t keysym) noexcept
+{
+    if (keysym >= 0x0061u && keysym <= 0x007au)
+        return offset_key(Key::A, keysym - 0x0061u);
+    if (keysym >= 0x0041u && keysym <= 0x005au)
+        return offset_key(Key::A, keysym - 0x0041u);
+    if (keysym >= 0x0030u && keysym <= 0x0039u)
+        return offset_key(Key::Num0, keysym - 0x0030u);
+    if (keysym >= 0xffbeu && keysym <= 0xffc9u)
+        return offset_key(Key::F1, keysym - 0xffbeu);
+    if (keysym >= 0xffb0u && keysym <= 0xffb9u)
+        return offset_key(Key::Keypad0, keysym - 0xffb0u);
+
+    switch (keysym)
+    {
+    case 0xff1bu:
+        return Key::Escape;
+    case 0xff0du:
+        return Key::Enter;
+    case 0xff09u:
+    case 0xfe20u:
+        return Key::Tab;
+    case 0xff08u:
+        return Key::Backspace;
+    case 0x0020u:
+        return Key::Space;
+    case 0x002du:
+        return Key::Minus;
+    case 0x003du:
+        return Key::Equal;
+    case 0x005bu:
+        return Key::LeftBracket;
+    case 0x005du:
+        return Key::RightBracket;
+    case 0x005cu:
+        return Key::Backslash;
+    case 0x003bu:
+        return Key::Semicolon;
+    case 0x0027u:
+        return Key::Apostrophe;
+    case 0x0060u:
+        return Key::Grave;
+    case 0x002cu:
+        return Key::Comma;
+    case 0x002eu:
+        return Key::Period;
+    case 0x002fu:
+        return Key::Slash;
+    case 0xff51u:
+        return Key::Left;
+    case 0xff53u:
+        return Key::Right;
+    case 0xff52u:
+        return Key::Up;
+    case 0xff54u:
+        return Key::Down;
+    case 0xff63u:
+        return Key::Insert;
+    case 0xffffu:
+        return Key::Delete;
+    case 0xff50u:
+        return Key::Home;
+    case 0xff57u:
+        return Key::End;
+    case 0xff55u:
+        return Key::PageUp;
+    case 0xff56u:
+        return Key::PageDown;
+    case 0xffe1u:
+        return Key::LeftShift;
+    case 0xffe2u:
+        return Key::RightShift;
+    case 0xffe3u:
+        return Key::LeftControl;
+    case 0xffe4u:
+        return Key::RightControl;
+    case 0xffe9u:
+        return Key::LeftAlt;
+    case 0xffeau:
+    case 0xfe03u:
+        return Key::RightAlt;
+    case 0xffebu:
+        return Key::LeftSuper;
+    case 0xffecu:
+        return Key::RightSuper;
+    case 0xffe5u:
+        return Key::CapsLock;
+    case 0xff7fu:
+        return Key::NumLock;
+    case 0xff14u:
+        return Key::ScrollLock;
+    case 0xff61u:
+        return Key::PrintScreen;
+    case 0xff13u:
+        return Key::Pause;
+    case 0xff67u:
+        return Key::Menu;
+    // Keypad keys report their navigation symbol in column 0 while Num Lock is off.
+    case 0xff9eu:
+        return Key::Keypad0;
+    case 0xff9cu:
+        return Key::Keypad1;
+    case 0xff99u:
+        return Key::Keypad2;
+    case 0xff9bu:
+        return Key::Keypad3;
+    case 0xff96u:
+        return Key::Keypad4;
+    case 0xff9du:
+        return Key::Keypad5;
+    case 0xff98u:
+        return Key::Keypad6;
+    case 0xff95u:
+        return Key::Keypad7;
+    case 0xff97u:
+        return Key::Keypad8;
+    case 0xff9au:
+        return Key::Keypad9;
+    case 0xff9fu:
+    case 0xffaeu:
+        return Key::KeypadDecimal;
+    case 0xffafu:
+        return Key::KeypadDivide;
+    case 0xffaau:
+        return Key::KeypadMultiply;
+    case 0xffadu:
+        return Key::KeypadSubtract;
+    case 0xffabu:
+        return Key::KeypadAdd;
+    case 0xff8du:
+        return Key::KeypadEnter;
+    default:
+        return Key::Unknown;
+    }
+}
+
+// The pointer can be reported outside the window while a button is held.
+static constexpr Position to_position(i16 x, i16 y) noexcept
+{
+    return { static_cast<u32>(std::max<i16>(x, 0)), static_cast<u32>(std::max<i16>(y, 0)) };
+}
+
+static constexpr f32 to_f32(xcb_input_fp3232_t value) noexcept
+{
+    return static_cast<f32>(static_cast<f64>(value.integral) + static_cast<f64>(value.frac) / 4294967296.0);
+}
 
 LinuxWindow::LinuxWindow(const std::string& title, WindowCreateFlags flags)
-    : Window(std::hash<std::string>()(title)), m_rect(), m_wid(static_cast<xcb_window_t>(-1)),
+    : Window(std::hash<std::string>()(title)), m_rect(), m_wid(static_cast<xcb_window_t>(-1)), m_gc(0u), m_depth(0u),
       m_atoms({ { s_wm_protocols_name, { static_cast<xcb_atom_t>(-1), XCB_ATOM_ATOM, 32 } },
-                { s_wm_delete_window_name, { static_cast<xcb_atom_t>(-1), XCB_ATOM_STRING, 8 } } })
+                { s_wm_delete_window_name, { static_cast<xcb_atom_t>(-1), XCB_ATOM_STRING, 8 } } }),
+      m_keymap(), m_key_symbols(nullptr), m_pending_release(), m_has_pending_release(false), m_raw_motion(),
+      m_pointer_pos(), m_pointer_moved(false), m_pointer_tracked(false),
+      m_focused(false)
 {
-    if (!s_connection)
+    m_raw_motion.reserve(s_raw_motion_reserve);
+
+    const bool new_connection{ !s_connection };
+    if (new_connection)
     {
         s_connection = xcb_connect(nullptr, nullptr);
         if (xcb_connection_has_error(s_connection))
@@ -28,6 +211,14 @@ LinuxWindow::LinuxWindow(const std::string& title, WindowCreateFlags flags)
 
     const xcb_screen_t* screen{ xcb_setup_roots_iterator(xcb_get_setup(s_connection)).data };
 
+    if (new_connection)
+        select_raw_motion(screen->root);
+
+    m_key_symbols = xcb_key_symbols_alloc(s_connection);
+    if (!m_key_symbols)
+        throw WindowError("Failed to allocate key symbol table.");
+    build_keymap();
+
     const u32 half_screen_width{ screen->width_in_pixels / 2u };
     const u32 half_screen_height{ screen->height_in_pixels / 2u };
     const u32 half_window_width{ s_width / 2u };
@@ -41,7 +232,8 @@ LinuxWindow::LinuxWindow(const std::string& title, WindowCreateFlags flags)
     constexpr u32 cw_mask{ XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK };
     const u32 cw_list[2]{ screen->black_pixel, XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE |
                                                    XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
-                                                   XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_STRUCTURE_NOTIFY };
+                                                   XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+                                                   XCB_EVENT_MASK_FOCUS_CHANGE | XCB_EVENT_MASK_EXPOSURE };
 
     m_wid = xcb_generate_id(s_connection);
     if (m_wid == static_cast<xcb_window_t>(-1))
@@ -51,6 +243,15 @@ LinuxWindow::LinuxWindow(const std::string& title, WindowCreateFlags flags)
                       static_cast<i16>(m_rect.pos.y), static_cast<u16>(m_rect.size.w), static_cast<u16>(m_rect.size.h),
                       0u, XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, cw_mask, cw_list);
 
+    // Surface pixels are 32-bit BGRX, which is the ZPixmap layout of the usual 24-bit TrueColor root visual.
+    m_depth = screen->root_depth;
+    if (m_depth != 24u && m_depth != 32u)
+        SURREAL_LOG_WARN("Root depth is {}; window surfaces will not be presented.", m_depth);
+    m_gc = xcb_generate_id(s_connection);
+    xcb_create_gc(s_connection, m_gc, m_wid, 0u, nullptr);
+    m_surface.resize(m_rect.size);
+    m_hit_regions.set_bounds(m_rect.size);
+
     for (auto& [name, atom] : m_atoms)
     {
         auto reply{ xcb_intern_atom_reply(
@@ -71,19 +272,31 @@ LinuxWindow::LinuxWindow(const std::string& title, WindowCreateFlags flags)
 
 LinuxWindow::~LinuxWindow()
 {
+    xcb_key_symbols_free(m_key_symbols);
+    xcb_free_gc(s_connection, m_gc);
     xcb_destroy_window(s_connection, m_wid);
     --s_window_count;
 
     if (!s_window_count)
+    {
         xcb_disconnect(s_connection);
+        s_connection = nullptr;
+        s_xinput_opcode = 0u;
+    }
 }
 
 void LinuxWindow::on_update()
 {
+    m_keyboard.begin_frame();
+
     xcb_generic_event_t* generic_event{ nullptr };
     while ((generic_event = xcb_poll_for_event(s_connection)))
     {
-        switch (XCB_EVENT_RESPONSE_TYPE(generic_event))
+        const u8 response_type{ static_cast<u8>(XCB_EVENT_RESPONSE_TYPE(generic_event)) };
+        if (m_has_pending_release && response_type != XCB_KEY_PRESS)
+            flush_pending_release();
+
+        switch (response_type)
         {
         case XCB_BUTTON_PRESS:
             on_button_press(reinterpret_cast<xcb_button_press_event_t*>(generic_event));
@@ -97,18 +310,68 @@ void LinuxWindow::on_update()
         case XCB_CONFIGURE_NOTIFY:
             on_configure_notify(reinterpret_cast<xcb_configure_notify_event_t*>(generic_event));
             break;
+        case XCB_EXPOSE:
+            on_expose(reinterpret_cast<xcb_expose_event_t*>(generic_event));
+            break;
         case XCB_KEY_PRESS:
             on_key_press(reinterpret_cast<xcb_key_press_event_t*>(generic_event));
             break;
         case XCB_KEY_RELEASE:
             on_key_release(reinterpret_cast<xcb_key_release_event_t*>(generic_event));
             break;
+        case XCB_MAPPING_NOTIFY:
+            on_mapping_notify(reinterpret_cast<xcb_mapping_notify_event_t*>(generic_event));
+            break;
+        case XCB_MOTION_NOTIFY:
+            on_motion_notify(reinterpret_cast<xcb_motion_notify_event_t*>(generic_event));
+            break;
+        case XCB_FOCUS_IN:
+            on_focus_change(true);
+            break;
+        case XCB_FOCUS_OUT:
+            on_focus_change(false);
+            break;
+        case XCB_GE_GENERIC:
+            on_generic_event(reinterpret_cast<xcb_ge_generic_event_t*>(generic_event));
+            break;
         default:
             break;
         }
 
         free(generic_event);
     }
+
+    if (m_has_pending_release)
+        flush_pending_release();
+    flush_pointer_motion();
+}
+
+void LinuxWindow::present()
+{
+    // Stale contents are an old frame or garbage; the surface stays dirty and goes out once it has been redrawn.
+    if (!m_surface.is_dirty() || m_surface.needs_redraw())
+        return;
+    m_surface.mark_clean();
+
+    const Size size{ m_surface.get_size() };
+    if (!size.w || !size.h || (m_depth != 24u && m_depth != 32u))
+        return;
+
+    // One PutImage per band of rows that fits the maximum request length, minus the 24-byte request header.
+    constexpr u32 put_image_header{ 24u };
+    const u32 row_bytes{ size.w * static_cast<u32>(sizeof(Pixel)) };
+    const u32 max_bytes{ xcb_get_maximum_request_length(s_connection) * 4u - put_image_header };
+    const u32 band_rows{ std::max(max_bytes / row_bytes, 1u) };
+
+    const std::span<const Pixel> pixels{ std::as_const(m_surface).get_pixels() };
+    for (u32 y{ 0u }; y < size.h; y += band_rows)
+    {
+        const u32 rows{ std::min(band_rows, size.h - y) };
+        xcb_put_image(s_connection, XCB_IMAGE_FORMAT_Z_PIXMAP, m_wid, m_gc, static_cast<u16>(size.w),
+                      static_cast<u16>(rows), 0, static_cast<i16>(y), 0u, m_depth, rows * row_bytes,
+                      reinterpret_cast<const u8*>(pixels.data() + static_cast<std::size_t>(y) * size.w));
+    }
+    xcb_flush(s_connection);
 }
 
 void LinuxWindow::show() noexcept
@@ -146,6 +409,13 @@ void LinuxWindow::on_configure_notify(xcb_configure_notify_event_t* config_notif
         m_rect.size.w = config_notify->width;
         m_rect.size.h = config_notify->height;
 
+        const Size surface_size{ m_surface.get_size() };
+        if (surface_size.w != m_rect.size.w || surface_size.h != m_rect.size.h)
+        {
+            m_surface.resize(m_rect.size);
+            m_hit_regions.set_bounds(m_rect.size);
+        }
+
         for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
         {
             auto handler{ *phandler };
@@ -157,34 +427,256 @@ void LinuxWindow::on_configure_notify(xcb_configure_notify_event_t* config_notif
     }
 }
 
+void LinuxWindow::on_expose(xcb_expose_event_t* expose)
+{
+    // The server does not keep the window's contents, so uncovered areas are blank until the surface is presented
+    // again, which for a stale surface waits for the redraw. Exposures come in a batch; count is the number still to
+    // come.
+    if (expose->window == m_wid && !expose->count)
+        m_surface.mark_dirty();
+}
+
 void LinuxWindow::on_key_press(xcb_key_press_event_t* key_press)
 {
+    if (m_has_pending_release)
+    {
+        if (m_pending_release.detail == key_press->detail && m_pending_release.time == key_press->time)
+            m_has_pending_release = false;
+        else
+            flush_pending_release();
+    }
+
+    const Key key{ m_keymap[key_press->detail] };
+    const bool repeat{ key != Key::Unknown && !m_keyboard.press(key) };
+
     for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
     {
         auto handler{ *phandler };
-        KeyPressEvent e{ key_press->detail };
+        KeyPressEvent e{ key, key_press->detail, repeat };
         (*handler)(e);
     }
 }
 
 void LinuxWindow::on_key_release(xcb_key_release_event_t* key_release)
 {
+    if (m_has_pending_release)
+        flush_pending_release();
+
+    m_pending_release = *key_release;
+    m_has_pending_release = true;
+}
+
+void LinuxWindow::flush_pending_release()
+{
+    m_has_pending_release = false;
+
+    const Key key{ m_keymap[m_pending_release.detail] };
+    m_keyboard.release(key);
+
     for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
     {
         auto handler{ *phandler };
-        KeyReleaseEvent e{ key_release->detail };
+        KeyReleaseEvent e{ key, m_pending_release.detail };
         (*handler)(e);
     }
 }
 
+void LinuxWindow::on_mapping_notify(xcb_mapping_notify_event_t* mapping_notify)
+{
+    if (mapping_notify->request != XCB_MAPPING_KEYBOARD && mapping_notify->request != XCB_MAPPING_MODIFIER)
+        return;
+
+    xcb_refresh_keyboard_mapping(m_key_symbols, mapping_notify);
+    build_keymap();
+}
+
+void LinuxWindow::build_keymap()
+{
+    const xcb_setup_t* setup{ xcb_get_setup(s_connection) };
+
+    m_keymap.fill(Key::Unknown);
+    for (u32 keycode{ setup->min_keycode }; keycode <= setup->max_keycode; ++keycode)
+    {
+        const xcb_keysym_t keysym{ xcb_key_symbols_get_keysym(m_key_symbols, static_cast<xcb_keycode_t>(keycode), 0) };
+        m_keymap[keycode] = keysym_to_key(keysym);
+    }
+}
+
 void LinuxWindow::on_button_press(xcb_button_press_event_t* button_press)
 {
-    fmt::print("Button pressed: {}\n", button_press->detail);
+    const Position pos{ to_position(button_press->event_x, button_press->event_y) };
+
+    // The core protocol reports wheel steps as presses of buttons 4 to 7.
+    if (button_press->detail >= 4 && button_press->detail <= 7)
+    {
+        const f32 dx{ button_press->detail == 6 ? -1.0f : button_press->detail == 7 ? 1.0f : 0.0f };
+        const f32 dy{ button_press->detail == 4 ? 1.0f : button_press->detail == 5 ? -1.0f : 0.0f };
+
+        MouseScrollEvent routed{ m_id, dx, dy, pos };
+        if (m_hit_regions.route(routed, pos))
+            return;
+
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            MouseScrollEvent e{ m_id, dx, dy, pos };
+            (*handler)(e);
+        }
+        return;
+    }
+
+    MouseButtonPressEvent routed{ m_id, to_mouse_button(button_press->detail), pos };
+    if (m_hit_regions.route(routed, pos))
+        return;
+
+    for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+    {
+        auto handler{ *phandler };
+        MouseButtonPressEvent e{ m_id, to_mouse_button(button_press->detail), pos };
+        (*handler)(e);
+    }
 }
 
 void LinuxWindow::on_button_release(xcb_button_release_event_t* button_release)
 {
-    fmt::print("Button released: {}\n", button_release->detail);
+    if (button_release->detail >= 4 && button_release->detail <= 7)
+        return;
+
+    const Position pos{ to_position(button_release->event_x, button_release->event_y) };
+    MouseButtonReleaseEvent routed{ m_id, to_mouse_button(button_release->detail), pos };
+    if (m_hit_regions.route(routed, pos))
+        return;
+
+    for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+    {
+        auto handler{ *phandler };
+        MouseButtonReleaseEvent e{ m_id, to_mouse_button(button_release->detail), pos };
+        (*handler)(e);
+    }
+}
+
+void LinuxWindow::on_motion_notify(xcb_motion_notify_event_t* motion_notify)
+{
+    const Position pos{ to_position(motion_notify->event_x, motion_notify->event_y) };
+
+    // Without XInput 2 the best we can offer as raw motion is the difference between core positions.
+    if (!s_xinput_opcode && m_pointer_tracked)
+    {
+        m_raw_motion.push_back({ static_cast<f32>(pos.x) - static_cast<f32>(m_pointer_pos.x),
+                                 static_cast<f32>(pos.y) - static_cast<f32>(m_pointer_pos.y), motion_notify->time });
+    }
+
+    m_pointer_pos = pos;
+    m_pointer_moved = true;
+    m_pointer_tracked = true;
+}
+
+void LinuxWindow::on_focus_change(bool focused)
+{
+    m_focused = focused;
+    if (focused)
+        return;
+
+    // Releases that happen while another window has focus are never seen, so the held keys are released here and the
+    // handlers get the events they would have, keeping any key state they track in step with m_keyboard.
+    for (u32 keycode{ 0u }; keycode < m_keymap.size(); ++keycode)
+    {
+        const Key key{ m_keymap[keycode] };
+        if (key == Key::Unknown || !m_keyboard.is_down(key))
+            continue;
+
+        m_keyboard.release(key);
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            KeyReleaseEvent e{ key, keycode };
+            (*handler)(e);
+        }
+    }
+}
+
+void LinuxWindow::on_generic_event(xcb_ge_generic_event_t* generic_event)
+{
+    if (!s_xinput_opcode || generic_event->extension != s_xinput_opcode)
+        return;
+
+    if (generic_event->event_type == XCB_INPUT_RAW_MOTION)
+        on_raw_motion(reinterpret_cast<xcb_input_raw_motion_event_t*>(generic_event));
+}
+
+void LinuxWindow::on_raw_motion(xcb_input_raw_motion_event_t* raw_motion)
+{
+    // Raw events are selected on the root window and arrive regardless of which window has focus.
+    if (!m_focused || !raw_motion->valuators_len)
+        return;
+
+    // Values are only present for the valuators set in the mask; X and Y are valuators 0 and 1.
+    const u32 mask{ xcb_input_raw_button_press_valuator_mask(raw_motion)[0] };
+    const xcb_input_fp3232_t* values{ xcb_input_raw_button_press_axisvalues_raw(raw_motion) };
+
+    MouseRawSample sample{ 0.0f, 0.0f, raw_motion->time };
+    if (mask & 1u)
+        sample.dx = to_f32(*values++);
+    if (mask & 2u)
+        sample.dy = to_f32(*values);
+
+    m_raw_motion.push_back(sample);
+}
+
+void LinuxWindow::select_raw_motion(xcb_window_t root)
+{
+    const xcb_query_extension_reply_t* extension{ xcb_get_extension_data(s_connection, &xcb_input_id) };
+    if (!extension || !extension->present)
+        return;
+
+    // 2.2 delivers raw events to the root window even while another client holds a grab.
+    auto reply{ xcb_input_xi_query_version_reply(s_connection, xcb_input_xi_query_version(s_connection, 2u, 2u),
+                                                 nullptr) };
+    if (!reply)
+        return;
+
+    const bool supported{ reply->major_version > 2 || (reply->major_version == 2 && reply->minor_version >= 2) };
+    free(reply);
+    if (!supported)
+        return;
+
+    struct
+    {
+        xcb_input_event_mask_t head;
+        u32 mask;
+    } event_mask{ { XCB_INPUT_DEVICE_ALL_MASTER, 1u }, XCB_INPUT_XI_EVENT_MASK_RAW_MOTION };
+
+    xcb_input_xi_select_events(s_connection, root, 1u, &event_mask.head);
+    s_xinput_opcode = extension->major_opcode;
+}
+
+void LinuxWindow::flush_pointer_motion()
+{
+    if (m_pointer_moved)
+    {
+        MouseMoveEvent routed{ m_id, m_pointer_pos };
+        if (!m_hit_regions.route(routed, m_pointer_pos))
+        {
+            for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+            {
+                auto handler{ *phandler };
+                MouseMoveEvent e{ m_id, m_pointer_pos };
+                (*handler)(e);
+            }
+        }
+        m_pointer_moved = false;
+    }
+
+    if (!m_raw_motion.empty())
+    {
+        for (auto phandler{ m_event_handlers.rbegin() }; phandler != m_event_handlers.rend(); ++phandler)
+        {
+            auto handler{ *phandler };
+            MouseRawMotionEvent e{ m_id, m_raw_motion };
+            (*handler)(e);
+        }
+        m_raw_motion.clear();
+    }
 }
 
 } // namespace Surreal
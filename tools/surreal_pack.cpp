@@ -0,0 +1,135 @@
+#include <core/asset.hpp>
+#include <core/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+struct Options
+{
+    std::string out_path;
+    std::vector<std::string> inputs;
+    std::string list_path;
+    Surreal::u32 alignment{ 4096u };
+    Surreal::AssetCompression compression{ Surreal::AssetCompression::Lz4 };
+};
+
+std::vector<Surreal::u8> read_file(const fs::path& path)
+{
+    std::ifstream in{ path, std::ios::binary };
+    if (!in)
+        throw Surreal::AssetError("Failed to open " + path.string() + ".");
+    return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+// Files are named by their path relative to the input they were found under, with '/' separators.
+void add_input(Surreal::AssetPackBuilder& builder, const fs::path& input, Surreal::AssetCompression compression)
+{
+    if (!fs::is_directory(input))
+    {
+        builder.add(input.filename().generic_string(), read_file(input), compression);
+        return;
+    }
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(input))
+        if (entry.is_regular_file())
+            files.push_back(entry.path());
+    std::sort(files.begin(), files.end());
+
+    for (const fs::path& file : files)
+        builder.add(fs::relative(file, input).generic_string(), read_file(file), compression);
+}
+
+int list_pack(const std::string& path)
+{
+    const Surreal::AssetPack pack{ path };
+    fmt::print("{:<48} {:>12} {:>12} {:>6}\n", "name", "size", "stored", "codec");
+    for (const Surreal::PackEntry& entry : pack.get_entries())
+        fmt::print("{:<48} {:>12} {:>12} {:>6}\n", pack.get_name(entry), entry.size, entry.stored_size,
+                   entry.compression == Surreal::AssetCompression::Lz4 ? "lz4" : "raw");
+    return 0;
+}
+
+void print_usage(const char* argv0)
+{
+    fmt::print(stderr,
+               "Usage: {0} -o <pack> [options] <file or directory>...\n"
+               "       {0} --list <pack>\n"
+               "\n"
+               "Options:\n"
+               "  -o, --out <path>     Pack to write.\n"
+               "  --raw                Store every entry uncompressed.\n"
+               "  --align <bytes>      Blob alignment, a power of two (default 4096).\n"
+               "  --list <pack>        Print the entries of an existing pack.\n",
+               argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opts;
+
+    for (int i{ 1 }; i < argc; ++i)
+    {
+        const std::string_view arg{ argv[i] };
+        const bool has_value{ i + 1 < argc };
+
+        if ((arg == "-o" || arg == "--out") && has_value)
+            opts.out_path = argv[++i];
+        else if (arg == "--raw")
+            opts.compression = Surreal::AssetCompression::None;
+        else if (arg == "--align" && has_value)
+            opts.alignment = static_cast<Surreal::u32>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--list" && has_value)
+            opts.list_path = argv[++i];
+        else if (arg == "-h" || arg == "--help" || arg.starts_with('-'))
+        {
+            print_usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 2;
+        }
+        else
+            opts.inputs.emplace_back(arg);
+    }
+
+    try
+    {
+        if (!opts.list_path.empty())
+            return list_pack(opts.list_path);
+
+        if (opts.out_path.empty() || opts.inputs.empty())
+        {
+            print_usage(argv[0]);
+            return 2;
+        }
+
+        Surreal::AssetPackBuilder builder{ opts.alignment };
+        for (const std::string& input : opts.inputs)
+            add_input(builder, input, opts.compression);
+
+        Surreal::ThreadPool pool;
+        builder.write(opts.out_path, pool);
+        fmt::print(stderr, "Wrote {} entries to {}.\n", builder.get_entry_count(), opts.out_path);
+    }
+    catch (const std::exception& e)
+    {
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}